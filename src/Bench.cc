@@ -0,0 +1,227 @@
+/****************************************************************************************[Bench.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <fstream>
+#include <functional>
+
+#include "Problem.h"
+#include "Parser.h"
+#include "utils/FeasibilityIndex.h"
+#include "utils/HeuristicSolver.h"
+#include "utils/ResourceKernel.h"
+#include "utils/TemporalAnalysis.h"
+#include "utils/ValidityChecker.h"
+
+using namespace RcpsptExact;
+
+/**
+ * Runs f the given number of times, and returns the average time per run in microseconds.
+ */
+static double timeRuns(int runs, const function<void()>& f) {
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < runs; r++) f();
+    auto end = chrono::steady_clock::now();
+    return (double)chrono::duration_cast<chrono::nanoseconds>(end - start).count() / 1000.0 / runs;
+}
+
+static bool sameProblem(const Problem& a, const Problem& b) {
+    if (a.njobs != b.njobs || a.horizon != b.horizon || a.nresources != b.nresources) return false;
+    if (a.successors != b.successors || a.predecessors != b.predecessors || a.durations != b.durations) return false;
+    for (int i = 0; i < a.njobs; i++)
+        if (!equal(a.requests(i, 0), a.requests(i, 0) + a.nresources * a.durations[i], b.requests(i, 0))) return false;
+    return equal(a.capacities(0), a.capacities(0) + a.nresources * a.horizon, b.capacities(0));
+}
+
+/**
+ * Compares the ifstream-based parser to the memory-mapped parser.
+ * Output per file: file, t_ifstream (us), t_mmap (us), speedup, equal (0/1)
+ * For an invalid file: file, error: reason, equal (0/1, whether both parsers reject it for the same reason)
+ */
+static void benchParser(const vector<string>& files, int runs) {
+    for (const string& file : files) {
+        string streamError, mmapError;
+        try {
+            ifstream input(file);
+            Parser::parseProblemInstance(input);
+        }
+        catch (const InvalidInstance& e) { streamError = e.what(); }
+        try {
+            Parser::parseProblemInstance(file);
+        }
+        catch (const InvalidInstance& e) { mmapError = e.what(); }
+        if (!streamError.empty() || !mmapError.empty()) {
+            std::cout << file << ", error: " << (mmapError.empty() ? streamError : mmapError) << ", " << (streamError == mmapError) << std::endl;
+            continue;
+        }
+
+        double tStream = timeRuns(runs, [&]() {
+            ifstream input(file);
+            Problem problem = Parser::parseProblemInstance(input);
+        });
+        double tMmap = timeRuns(runs, [&]() {
+            Problem problem = Parser::parseProblemInstance(file);
+        });
+        ifstream input(file);
+        bool equal = sameProblem(Parser::parseProblemInstance(input), Parser::parseProblemInstance(file));
+        std::cout << file << ", " << tStream << ", " << tMmap << ", " << tStream / tMmap << ", " << equal << std::endl;
+    }
+}
+
+/**
+ * Times the scans over requests and capacities that are done before encoding.
+ * Output per file: file, t_bounds (us), t_windows (us), t_check (us)
+ */
+static void benchWindows(const vector<string>& files, int runs) {
+    for (const string& file : files) {
+        Problem problem = Parser::parseProblemInstance(file);
+        vector<int> schedule;
+        pair<int,int> bounds;
+        double tBounds = timeRuns(max(1, runs / 100), [&]() {
+            bounds = calcBoundsPriorityRule(problem, schedule);
+        });
+        double tWindows = timeRuns(runs, [&]() {
+            TemporalAnalysis temporal(problem); // Not the cached analysis of the problem, so every run builds it
+            temporal.windows(bounds.second);
+        });
+        double tCheck = timeRuns(runs, [&]() {
+            ValidityChecker::checkValid(problem, schedule);
+        });
+        std::cout << file << ", " << tBounds << ", " << tWindows << ", " << tCheck << std::endl;
+    }
+}
+
+/**
+ * Finds the next feasible start time of a job by shifting the candidate one step at a time (as done before the index).
+ */
+static int nextStartShifting(const Problem& problem, int job, int s) {
+    int duration = problem.durations[job];
+    for (; s + duration <= problem.horizon; s++) {
+        bool feasible = true;
+        for (int k = 0; feasible && k < problem.nresources; k++) {
+            const int* requests = problem.requests(job, k);
+            const int* capacities = problem.capacities(k) + s;
+            for (int t = duration - 1; feasible && t >= 0; t--)
+                if (requests[t] > capacities[t]) feasible = false;
+        }
+        if (feasible) return s;
+    }
+    return -1;
+}
+
+/**
+ * Compares finding the next feasible start time (for every job and every candidate start time) by shifting the candidate
+ * to using the FeasibilityIndex. Capacities that often dip below the requests make the shifting approach slow.
+ * Output per file: file, t_build (us), t_shifting (us), t_index (us), speedup (including build), equal (0/1)
+ */
+static void benchStarts(const vector<string>& files, int runs) {
+    for (const string& file : files) {
+        Problem problem = Parser::parseProblemInstance(file);
+        volatile long sum = 0; // Keeps the timed loops from being optimised away
+        double tBuild = timeRuns(runs, [&]() {
+            FeasibilityIndex index(problem);
+        });
+        double tShifting = timeRuns(runs, [&]() {
+            for (int i = 0; i < problem.njobs; i++)
+                for (int s = 0; s <= problem.horizon; s++) sum += nextStartShifting(problem, i, s);
+        });
+        FeasibilityIndex index(problem);
+        double tIndex = timeRuns(runs, [&]() {
+            for (int i = 0; i < problem.njobs; i++)
+                for (int s = 0; s <= problem.horizon; s++) sum += index.nextStart(i, s);
+        });
+        bool equal = true;
+        for (int i = 0; equal && i < problem.njobs; i++)
+            for (int s = 0; equal && s <= problem.horizon; s++)
+                equal = nextStartShifting(problem, i, s) == index.nextStart(i, s);
+        std::cout << file << ", " << tBuild << ", " << tShifting << ", " << tIndex << ", "
+                  << tShifting / (tBuild + tIndex) << ", " << equal << std::endl;
+    }
+}
+
+/**
+ * Compares the scalar and AVX2 implementations of the resource kernels, probing every job at every start time
+ * against the capacities (one window at a time, and in blocks of ResourceKernel::MAX_STARTS start times).
+ * Output per file: file, t_first_scalar (us), t_first_avx2 (us), t_mask_scalar (us), t_mask_avx2 (us), equal (0/1)
+ */
+static void benchKernel(const vector<string>& files, int runs) {
+    for (const string& file : files) {
+        Problem problem = Parser::parseProblemInstance(file);
+        auto probeFirst = [&]() {
+            long sum = 0;
+            for (int i = 0; i < problem.njobs; i++)
+                for (int k = 0; k < problem.nresources; k++)
+                    for (int s = 0; s + problem.durations[i] <= problem.horizon; s++)
+                        sum += ResourceKernel::firstViolation(problem.requests(i, k), problem.capacities(k) + s, problem.durations[i]);
+            return sum;
+        };
+        auto probeMask = [&]() {
+            long sum = 0;
+            for (int i = 0; i < problem.njobs; i++) {
+                for (int k = 0; k < problem.nresources; k++) {
+                    int last = problem.horizon - problem.durations[i];
+                    for (int s = 0; s <= last; s += ResourceKernel::MAX_STARTS) {
+                        int nstarts = min(ResourceKernel::MAX_STARTS, last - s + 1);
+                        sum += ResourceKernel::violationMask(problem.requests(i, k), problem.capacities(k) + s, problem.durations[i], nstarts);
+                    }
+                }
+            }
+            return sum;
+        };
+        volatile long sum; // Keeps the timed loops from being optimised away
+        bool avx2 = ResourceKernel::useAvx2(false);
+        long firstScalar = probeFirst(), maskScalar = probeMask();
+        double tFirstScalar = timeRuns(runs, [&]() { sum = probeFirst(); });
+        double tMaskScalar = timeRuns(runs, [&]() { sum = probeMask(); });
+        avx2 = ResourceKernel::useAvx2(true);
+        if (!avx2) std::cerr << "AVX2 is not supported, comparing the scalar implementation to itself" << std::endl;
+        bool equal = firstScalar == probeFirst() && maskScalar == probeMask();
+        double tFirstAvx2 = timeRuns(runs, [&]() { sum = probeFirst(); });
+        double tMaskAvx2 = timeRuns(runs, [&]() { sum = probeMask(); });
+        std::cout << file << ", " << tFirstScalar << ", " << tFirstAvx2 << ", " << tMaskScalar << ", " << tMaskAvx2 << ", "
+                  << equal << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cout << "Please provide the following arguments: benchmark[parser/windows/starts/kernel] input[path_to_file]..." << std::endl;
+        return 1;
+    }
+
+    string benchmark = argv[1];
+    vector<string> files(argv + 2, argv + argc);
+
+    if (benchmark == "parser") benchParser(files, 200);
+    else if (benchmark == "windows") benchWindows(files, 200);
+    else if (benchmark == "starts") benchStarts(files, 5);
+    else if (benchmark == "kernel") benchKernel(files, 20);
+    else {
+        std::cout << "Argument benchmark[parser/windows/starts/kernel] not recognised" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
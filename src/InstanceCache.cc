@@ -0,0 +1,117 @@
+/********************************************************************************[InstanceCache.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+#include "InstanceCache.h"
+#include "Parser.h"
+
+using namespace RcpsptExact;
+
+static const char MAGIC[8] = "RCPSPTC";
+
+static uint64_t fnv1a(const char* data, size_t size) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static void appendAdjacency(vector<int32_t>& payload, const vector<vector<int>>& lists) {
+    int32_t offset = 0;
+    payload.push_back(offset);
+    for (const vector<int>& list : lists) {
+        offset += (int32_t)list.size();
+        payload.push_back(offset);
+    }
+    for (const vector<int>& list : lists) payload.insert(payload.end(), list.begin(), list.end());
+}
+
+bool InstanceCache::write(const Problem& problem, const string& filePath) {
+    vector<int32_t> payload;
+    payload.insert(payload.end(), problem.durations.begin(), problem.durations.end());
+    appendAdjacency(payload, problem.successors);
+    appendAdjacency(payload, problem.predecessors);
+    for (int i = 0; i < problem.njobs; i++) {
+        const int* requests = problem.requests(i, 0); // Rows of all resources are consecutive
+        payload.insert(payload.end(), requests, requests + problem.nresources * problem.durations[i]);
+    }
+    const int* capacities = problem.capacities(0); // Rows of all resources are consecutive
+    payload.insert(payload.end(), capacities, capacities + problem.nresources * problem.horizon);
+
+    InstanceCacheHeader header{};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.njobs = problem.njobs;
+    header.horizon = problem.horizon;
+    header.nresources = problem.nresources;
+    header.payloadSize = payload.size() * sizeof(int32_t);
+    header.checksum = fnv1a((const char*)payload.data(), header.payloadSize);
+
+    ofstream outFile(filePath, ios::binary);
+    outFile.write((const char*)&header, sizeof(header));
+    outFile.write((const char*)payload.data(), (streamsize)header.payloadSize);
+    outFile.close();
+    return !outFile.fail();
+}
+
+bool InstanceCache::isCache(const char* data, size_t size) {
+    return size >= sizeof(InstanceCacheHeader) && memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+Problem InstanceCache::load(const char* data, size_t size) {
+    InstanceCacheHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.version != VERSION)
+        throw InvalidInstance("unsupported instance cache version " + to_string(header.version) + " (expected " + to_string(VERSION) + ")");
+    const char* payloadData = data + sizeof(header);
+    if (size - sizeof(header) != header.payloadSize || fnv1a(payloadData, header.payloadSize) != header.checksum)
+        throw InvalidInstance("instance cache is corrupted (size or checksum mismatch)");
+
+    Problem result(header.njobs, header.horizon, header.nresources);
+    const int32_t* p = (const int32_t*)payloadData;
+
+    for (int i = 0; i < header.njobs; i++) result.addJob(p[i]);
+    p += header.njobs;
+
+    for (vector<vector<int>>* lists : {&result.successors, &result.predecessors}) {
+        const int32_t* offsets = p;
+        const int32_t* values = p + header.njobs + 1;
+        for (int i = 0; i < header.njobs; i++)
+            (*lists)[i].assign(values + offsets[i], values + offsets[i + 1]);
+        p = values + offsets[header.njobs];
+    }
+
+    for (int i = 0; i < header.njobs; i++) {
+        copy(p, p + header.nresources * result.durations[i], result.requests(i, 0));
+        p += header.nresources * result.durations[i];
+    }
+
+    copy(p, p + header.nresources * header.horizon, result.capacities(0));
+
+    return result;
+}
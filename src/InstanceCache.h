@@ -0,0 +1,94 @@
+/*********************************************************************************[InstanceCache.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+#ifndef RCPSPT_EXACT_INSTANCECACHE_H
+#define RCPSPT_EXACT_INSTANCECACHE_H
+
+#include <cstdint>
+#include <string>
+
+#include "Problem.h"
+
+using namespace std;
+
+namespace RcpsptExact {
+
+/**
+ * Header of a binary cached instance file. All values are stored in native (little-endian) byte order.
+ * The header is followed by a payload of 32-bit integers, in this order:
+ *  - durations (njobs values)
+ *  - successor offsets (njobs+1 values), followed by the successor lists of all jobs
+ *  - predecessor offsets (njobs+1 values), followed by the predecessor lists of all jobs
+ *  - requests: for each job, for each resource, one value per time step of the job's duration
+ *  - capacities: for each resource, horizon values
+ */
+struct InstanceCacheHeader {
+    char magic[8];        // Always "RCPSPTC" (null-terminated)
+    uint32_t version;     // Format version, see InstanceCache::VERSION
+    int32_t njobs;
+    int32_t horizon;
+    int32_t nresources;
+    uint64_t payloadSize; // Number of bytes following the header
+    uint64_t checksum;    // FNV-1a hash of the payload
+};
+
+/**
+ * Class containing functions for converting instances of the RCPSP/t to and from a compact binary format,
+ * so that batch runs do not need to parse the same text instance over and over again.
+ * Loading a cache file only copies its values into the Problem vectors, without any parsing.
+ */
+class InstanceCache {
+public:
+    static const uint32_t VERSION = 1;
+
+    /**
+     * Writes the given problem instance to a binary cache file.
+     *
+     * @param problem the problem instance to write
+     * @param filePath path of the cache file
+     * @return true if the file was written successfully, false otherwise
+     */
+    static bool write(const Problem& problem, const string& filePath);
+
+    /**
+     * Checks whether the given buffer starts with the header of a binary cache file.
+     *
+     * @param data pointer to the first byte of the buffer
+     * @param size number of bytes in the buffer
+     */
+    static bool isCache(const char* data, size_t size);
+
+    /**
+     * Loads a problem instance from a buffer containing a binary cache file.
+     * Throws InvalidInstance (see Parser) if the version or checksum of the cache does not match, so that a batch run
+     * can report the instance and continue with the others.
+     *
+     * @param data pointer to the first byte of the buffer (should be 4-byte aligned, e.g. from mmap)
+     * @param size number of bytes in the buffer
+     * @return the Problem instance containing the cached data
+     */
+    static Problem load(const char* data, size_t size);
+};
+}
+
+#endif //RCPSPT_EXACT_INSTANCECACHE_H
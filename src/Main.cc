@@ -20,33 +20,216 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 **************************************************************************************************/
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <csignal>
+#include <cstdlib>
+#include <filesystem>
 #include <iostream>
 #include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <chrono>
 #include <ctime>
 
 #include "Problem.h"
 #include "Parser.h"
+#include "InstanceCache.h"
 #include "encoders/SmtEncoder.h"
 #include "encoders/SatEncoder.h"
+#include "encoders/PortfolioEncoder.h"
 #include "utils/HeuristicSolver.h"
 #include "encoders/WcnfEncoder.h"
+#include "utils/MaxSatProcess.h"
+#include "utils/ParallelFor.h"
 
 using namespace RcpsptExact;
 
-YicesEncoder* enc;
+atomic<YicesEncoder*> enc(nullptr);
+
+// Encoding of the resource constraints, set with the option --pb=[name] (names in the order of PBEncodingType)
+PBEncodingType pbEncoding = PBEncodingType::AUTO;
+static const char* const PB_ENCODING_NAMES[] = {"bdd", "mdd", "totalizer", "sorting", "gtotalizer", "adder", "auto"};
 
 void signal_handler(int signal_num) {
-    if (enc == nullptr) exit(1);
+    YicesEncoder* e = enc;
+    if (e == nullptr) exit(1);
 //    std::cout << "received signal " << signal_num << std::endl;
-    smt_status_t status = yices_context_status(enc->ctx);
-    if (status == STATUS_SEARCHING) yices_stop_search(enc->ctx);
+    if (e->searching()) e->interrupt();
     else {
-        enc->printResults();
+        e->printResults();
+        exit(1);
+    }
+}
+
+// State for batch mode: whether the batch should be stopped, and a mutex that is held while the encoders are being
+// interrupted, so that solve() cannot delete an encoder in the meantime
+atomic<bool> batchStopped(false);
+mutex activeMutex;
+
+void batch_signal_handler(int signal_num) {
+    // Only set a flag: the encoders are interrupted by the watcher thread of solveBatch, as the signal handler cannot
+    // safely access encoders that may be deleted concurrently
+    batchStopped = true;
+}
+
+/**
+ * Parses an instance file for the modes that handle a single instance, exiting with an error if it is invalid.
+ */
+static Problem parseOrExit(const string& filePath) {
+    try {
+        return Parser::parseProblemInstance(filePath);
+    }
+    catch (const InvalidInstance& e) {
+        std::cerr << filePath << ": " << e.what() << std::endl;
         exit(1);
     }
 }
 
+/**
+ * Parses the argument for a number of threads.
+ *
+ * @return the number of threads, or 0 if the argument is not a positive integer
+ */
+static int parseThreads(const char* arg) {
+    char* end;
+    long n = strtol(arg, &end, 10);
+    return *arg != '\0' && *end == '\0' && n >= 1 && n <= INT32_MAX ? (int)n : 0;
+}
+
+/**
+ * Encodes the problem with a Yices encoder, optimises it, and outputs the results (see YicesEncoder::printResults).
+ * While the encoder exists it is stored in active, so that its search can be interrupted by a signal handler (or by the
+ * watcher thread of solveBatch). It is removed from active while holding activeMutex, before it is deleted.
+ *
+ * @param encoder name of the encoder to use (smt/sat/portfolio)
+ * @param problem the problem instance
+ * @param measurements measurements for this instance (should contain the file name and starting time)
+ * @param active where to store the encoder while it is in use
+ * @param out the stream to write the results to
+ * @param nthreads number of worker threads for calculating the initial bounds and encoding
+ * @return false if the encoder name is not recognised, true otherwise
+ */
+static bool solve(const string& encoder, Problem& problem, Measurements& measurements, atomic<YicesEncoder*>& active, ostream& out,
+                  int nthreads = defaultThreadCount()) {
+    long t_start_enc = measurements.now();
+    pair<int,int> bounds = calcBoundsPriorityRule(problem, measurements.schedule, nthreads);
+    YicesEncoder* e;
+    if ("smt" == encoder) e = new SmtEncoder(problem, bounds, &measurements, nthreads);
+    else if ("sat" == encoder) e = new SatEncoder(problem, bounds, &measurements);
+    else if ("portfolio" == encoder) e = new PortfolioEncoder(problem, bounds, &measurements, nthreads);
+    else return false;
+    e->nthreads = nthreads;
+    e->pbEncoding = pbEncoding;
+    active = e;
+    e->encode();
+    measurements.t_enc = measurements.now() - t_start_enc;
+
+    if (!measurements.schedule.empty()) {
+        long t_start_search = measurements.now();
+        if (!batchStopped) e->optimise();
+        measurements.t_search = measurements.now() - t_start_search;
+    }
+    else {
+        measurements.t_search = 0;
+        measurements.certified = true;
+    }
+
+    e->printResults(out);
+
+    {
+        lock_guard<mutex> lock(activeMutex);
+        active = nullptr;
+    }
+    delete e;
+    return true;
+}
+
+/**
+ * Solves all instances in a directory or list file on a number of worker threads, each using its own Yices context.
+ * The results are output in the order of the instances (sorted by path for a directory), as soon as they are available.
+ * For an instance file that cannot be parsed, the line "[path], error: [reason]" is output instead.
+ *
+ * @param encoder name of the encoder to use (smt/sat/portfolio)
+ * @param input path to a directory of instances, or to a file listing one instance path per line
+ * @param nthreads number of worker threads
+ * @return false if the encoder name is not recognised, true otherwise
+ */
+static bool solveBatch(const string& encoder, const string& input, int nthreads) {
+    if ("smt" != encoder && "sat" != encoder && "portfolio" != encoder) return false;
+
+    vector<string> files;
+    if (filesystem::is_directory(input)) {
+        for (const filesystem::directory_entry& entry : filesystem::directory_iterator(input))
+            if (entry.is_regular_file()) files.push_back(entry.path().string());
+        sort(files.begin(), files.end());
+    }
+    else {
+        ifstream listFile(input);
+        string line;
+        while (getline(listFile, line)) if (!line.empty()) files.push_back(line);
+    }
+
+    vector<atomic<YicesEncoder*>> encs(files.size());
+    for (atomic<YicesEncoder*>& e : encs) e = nullptr;
+    signal(SIGTERM, batch_signal_handler);
+    signal(SIGINT, batch_signal_handler);
+
+    // Once the batch is stopped, interrupt all running searches: their (partial) results are still output, and
+    // instances not yet started are skipped. Keep interrupting until all have returned, as a single stop request is
+    // lost when it arrives just before a search starts
+    atomic<bool> done(false);
+    thread watcher([&]() {
+        while (!done) {
+            if (batchStopped) {
+                lock_guard<mutex> lock(activeMutex);
+                for (atomic<YicesEncoder*>& e : encs) {
+                    YicesEncoder* curr = e;
+                    if (curr != nullptr) curr->interrupt();
+                }
+            }
+            this_thread::sleep_for(chrono::milliseconds(10));
+        }
+    });
+
+    mutex outputMutex;
+    vector<string> outputs(files.size());
+    vector<bool> finished(files.size(), false);
+    int nextOutput = 0;
+    int instanceThreads = max(1, defaultThreadCount() / nthreads); // Threads for the heuristic and encoding of an instance
+    parallelFor((int)files.size(), nthreads, [&](int i) {
+        if (!batchStopped) {
+            Measurements measurements;
+            measurements.file = files[i];
+            // Other instances are solved concurrently by the same process, so the CPU time of the process cannot be
+            // used. The CPU time of the calling thread misses the work on worker threads (such as the parallel
+            // construction of the PB encodings), so wall-clock time is used when an instance has worker threads
+            measurements.wallClock = "portfolio" == encoder || instanceThreads > 1;
+            measurements.threadClock = true;
+            measurements.t_start = measurements.now();
+            try {
+                Problem problem = Parser::parseProblemInstance(files[i]);
+                ostringstream out;
+                solve(encoder, problem, measurements, encs[i], out, instanceThreads);
+                outputs[i] = out.str();
+            }
+            catch (const InvalidInstance& e) {
+                outputs[i] = files[i] + ", error: " + e.what() + "\n";
+            }
+        }
+
+        lock_guard<mutex> lock(outputMutex);
+        finished[i] = true;
+        while (nextOutput < (int)files.size() && finished[nextOutput]) std::cout << outputs[nextOutput++] << std::flush;
+    });
+
+    done = true;
+    watcher.join();
+    return true;
+}
+
 int main(int argc, char** argv) {
     // register termination signal
     signal(SIGTERM, signal_handler);
@@ -54,43 +237,176 @@ int main(int argc, char** argv) {
     signal(SIGINT, signal_handler);
     signal(SIGABRT, signal_handler);
 
+    // Options may be given anywhere, they are removed from the (positional) arguments
+    int nargs = 0;
+    for (int a = 0; a < argc; a++) {
+        string arg = argv[a];
+        if (arg.rfind("--pb=", 0) != 0) {
+            argv[nargs++] = argv[a];
+            continue;
+        }
+        const char* const* name = find(begin(PB_ENCODING_NAMES), end(PB_ENCODING_NAMES), arg.substr(5));
+        if (name == end(PB_ENCODING_NAMES)) {
+            std::cout << "Option --pb=[bdd/mdd/totalizer/sorting/gtotalizer/adder/auto] not recognised" << std::endl;
+            return 1;
+        }
+        pbEncoding = (PBEncodingType)(name - begin(PB_ENCODING_NAMES));
+    }
+    argc = nargs;
+
     if (argc < 3) {
-        std::cout << "Please provide the following arguments: encoder[smt/sat/maxsat] input[path_to_file] (for maxsat: output[file_name])" << std::endl;
+        std::cout << "Please provide the following arguments: encoder[smt/sat/portfolio/maxsat] input[path_to_file] (for maxsat: output[file_name] (optional) format[wcnf/wcnf22/cnf])" << std::endl;
+        std::cout << "The portfolio encoder races smt and sat on two threads (requires Yices built with thread safety), its times are wall-clock times." << std::endl;
+        std::cout << "The other encoders report the CPU time of the whole process, including worker threads." << std::endl;
+        std::cout << "The encoding of the resource constraints can be set with the option --pb=[bdd/mdd/totalizer/sorting/gtotalizer/adder/auto] (default: auto," << std::endl;
+        std::cout << "chosen per constraint), for example --pb=bdd to reproduce results of versions that only had BDD-1." << std::endl;
         std::cout << std::endl << "Alternatively, use the following arguments for converting from a MaxSAT model to a solution for the original problem:" << std::endl;
-        std::cout << "mod2sol problem[path_to_original_problem_file] model[path_to_model_file]" << std::endl;
-        std::cout << "Then the output will look as follows: [path_to_original_problem_file], [makespan], [valid (0/1)], [solution (example: 0.2.3.8.)]" << std::endl;
+        std::cout << "mod2sol problem[path_to_original_problem_file] model[path_to_model_file] (optional) wcnf[path_to_wcnf_file]" << std::endl;
+        std::cout << "With the WCNF file, the model is decoded using the time windows in its header. Without it, the time windows are" << std::endl;
+        std::cout << "recomputed, which is only correct if the WCNF file was written by the same version of this program." << std::endl;
+        std::cout << "Then the output will look as follows: [path_to_original_problem_file], [makespan], [valid (0/1)], [solution (example: 0.2.3.8.)], [n_pb], [bdd_peak]" << std::endl;
+        std::cout << "Here [n_pb] is the number of resource constraints per PB encoding (in the order of the --pb option), and [bdd_peak] the peak memory in bytes" << std::endl;
+        std::cout << "used for a single decision diagram, both from the WCNF header (-1 if unknown)." << std::endl;
+        std::cout << std::endl << "To convert a problem file into a binary cache file (which can be used as input instead of the original file):" << std::endl;
+        std::cout << "cache problem[path_to_original_problem_file] output[path_to_cache_file]" << std::endl;
+        std::cout << std::endl << "To stream the MaxSAT encoding directly into a MaxSAT solver (which reads the headerless WCNF format from stdin):" << std::endl;
+        std::cout << "maxsatpipe problem[path_to_original_problem_file] solver[command]" << std::endl;
+        std::cout << "Then the output will look the same as for mod2sol." << std::endl;
+        std::cout << std::endl << "To convert many MaxSAT models at once (without rerunning preprocessing), using a list file with lines [problem] [wcnf] [model]:" << std::endl;
+        std::cout << "mod2solbatch list[path_to_list_file] (optional) threads[n]" << std::endl;
+        std::cout << "Then one line is output per list entry, in the same order and format as for mod2sol." << std::endl;
+        std::cout << std::endl << "To solve many instances with the smt/sat/portfolio encoder on multiple threads (requires Yices built with thread safety when threads>1):" << std::endl;
+        std::cout << "batch encoder[smt/sat/portfolio] input[path_to_directory/path_to_list_file] (optional) threads[n]" << std::endl;
+        std::cout << "Then one line is output per instance, in the same order and format as for a single instance." << std::endl;
+        std::cout << "In both batch modes, an instance file that cannot be parsed gives the line [path], error: [reason] instead." << std::endl;
+        std::cout << "Times are wall-clock times when an instance uses several threads (threads lower than the number of cores), otherwise CPU times of the thread solving the instance." << std::endl;
         return 1;
     }
 
     string filePath = argv[2];
 
+    if ("batch" == string(argv[1])) {
+        if (argc < 4) {
+            std::cout << "Please provide the following arguments: batch encoder[smt/sat/portfolio] input[path_to_directory/path_to_list_file] (optional) threads[n]" << std::endl;
+            return 1;
+        }
+
+        int nthreads = argc > 4 ? parseThreads(argv[4]) : defaultThreadCount();
+        if (nthreads < 1) {
+            std::cout << "Argument threads[n] should be a positive integer" << std::endl;
+            return 1;
+        }
+        if (!solveBatch(argv[2], argv[3], nthreads)) {
+            std::cout << "Argument encoder[smt/sat/portfolio] not recognised" << std::endl;
+            return 1;
+        }
+
+        return 0;
+    }
+
+    if ("mod2solbatch" == string(argv[1])) {
+        int nthreads = argc > 3 ? parseThreads(argv[3]) : defaultThreadCount();
+        if (nthreads < 1) {
+            std::cout << "Argument threads[n] should be a positive integer" << std::endl;
+            return 1;
+        }
+        vector<array<string,3>> entries; // (problem, wcnf, model) for each line in the list file
+        ifstream listFile(filePath);
+        array<string,3> entry;
+        while (listFile >> entry[0] >> entry[1] >> entry[2]) entries.push_back(entry);
+        listFile.close();
+
+        vector<string> outputs(entries.size());
+        parallelFor((int)entries.size(), nthreads, [&](int i) {
+            try {
+                Problem problem = Parser::parseProblemInstance(entries[i][0]);
+                outputs[i] = entries[i][0] + ", " + WcnfEncoder::decodeWithHeader(problem, entries[i][1], entries[i][2]);
+            }
+            catch (const InvalidInstance& e) {
+                outputs[i] = entries[i][0] + ", error: " + e.what();
+            }
+        });
+        for (const string& output : outputs) std::cout << output << '\n';
+        std::cout << std::flush;
+
+        return 0;
+    }
+
     Measurements measurements;
     measurements.file = filePath;
+    measurements.wallClock = "portfolio" == string(argv[1]);
+    measurements.t_start = measurements.now();
+
+    Problem problem = parseOrExit(filePath);
 
-    ifstream inpFile(filePath);
-    Problem problem = Parser::parseProblemInstance(inpFile);
-    inpFile.close();
+    if ("cache" == string(argv[1])) {
+        if (argc < 4) {
+            std::cout << "Please provide the following arguments: cache problem[path_to_original_problem_file] output[path_to_cache_file]" << std::endl;
+            return 1;
+        }
+
+        return InstanceCache::write(problem, argv[3]) ? 0 : 1;
+    }
 
     if ("mod2sol" == string(argv[1])) {
         if (argc < 4) {
-            std::cout << "Please provide the following arguments: mod2sol problem[path_to_original_problem_file] model[path_to_model_file]" << std::endl;
+            std::cout << "Please provide the following arguments: mod2sol problem[path_to_original_problem_file] model[path_to_model_file] (optional) wcnf[path_to_wcnf_file]" << std::endl;
             return 1;
         }
 
         string modelFilePath = argv[3];
+        if (argc > 4) {
+            std::cout << filePath << ", " << WcnfEncoder::decodeWithHeader(problem, argv[4], modelFilePath) << std::endl;
+            return 0;
+        }
+
+        // The bounds (and so the time windows) depend on the heuristic, which may differ from the version that wrote the WCNF file.
+        // The statistics of the encoding are unknown without the WCNF file
         ifstream modelFile(modelFilePath);
         string model;
         getline(modelFile, model);
 
         pair<int,int> bounds = calcBoundsPriorityRule(problem, measurements.schedule);
         WcnfEncoder maxSatEnc(problem, bounds);
-        string output = maxSatEnc.getAndCheckSolution(model);
+        string output = maxSatEnc.getAndCheckSolution(model) + WcnfEncoder::statsColumns(nullptr);
 
         std::cout << filePath << ", " << output << std::endl;
 
         return 0;
     }
 
+    if ("maxsatpipe" == string(argv[1])) {
+        if (argc < 4) {
+            std::cout << "Please provide the following arguments: maxsatpipe problem[path_to_original_problem_file] solver[command]" << std::endl;
+            return 1;
+        }
+
+        signal(SIGPIPE, SIG_IGN); // A solver that exits early should not terminate this process
+
+        pair<int,int> bounds = calcBoundsPriorityRule(problem, measurements.schedule);
+        WcnfEncoder maxSatEnc(problem, bounds);
+        maxSatEnc.pbEncoding = pbEncoding;
+        MaxSatProcess solver(argv[3]);
+        if (solver.input() < 0) return 1;
+        bool written = maxSatEnc.encodeAndWrite(solver.input(), true);
+        if (!solver.finish()) {
+            std::cerr << "MaxSAT solver did not exit normally" << std::endl;
+            return 1;
+        }
+        if (!written) {
+            std::cerr << "Cannot write the instance to the MaxSAT solver" << std::endl;
+            return 1;
+        }
+
+        string output;
+        if (!solver.model().empty()) output = maxSatEnc.getAndCheckSolution(solver.model());
+        else if (solver.status() == "UNSATISFIABLE") output = "-1, 1, ";
+        else output = "-1, 0, ";
+        std::cout << filePath << ", " << output << WcnfEncoder::statsColumns(&maxSatEnc.clauseStats()) << std::endl;
+
+        return 0;
+    }
+
     if ("maxsat" == string(argv[1])) {
         if (argc < 4) {
             std::cout << "Please provide the following arguments: encoder[smt/sat/maxsat] input[path_to_file] (for maxsat: output[file_name])" << std::endl;
@@ -98,40 +414,24 @@ int main(int argc, char** argv) {
         }
 
         string outFilePath = argv[3];
+        bool headerless = argc > 4 && "wcnf22" == string(argv[4]);
+        bool cnf = argc > 4 && "cnf" == string(argv[4]); // Only the hard clauses, for the upper bound of the heuristic
 
         pair<int,int> bounds = calcBoundsPriorityRule(problem, measurements.schedule);
         WcnfEncoder maxSatEnc(problem, bounds);
-        maxSatEnc.encodeAndWriteToFile(outFilePath);
+        maxSatEnc.pbEncoding = pbEncoding;
+        if (!maxSatEnc.encodeAndWriteToFile(outFilePath, headerless, cnf)) return 1;
 
-        // Output total encoding time in milis
-        std::cout << (long)(clock() * 1000 / CLOCKS_PER_SEC) << std::endl;
+        // Output total encoding time in milis, followed by the statistics of the encoding
+        std::cout << (long)(clock() * 1000 / CLOCKS_PER_SEC) << WcnfEncoder::statsColumns(&maxSatEnc.clauseStats()) << std::endl;
 
         return 0;
     }
 
-    clock_t t_start_enc = clock();
-    pair<int,int> bounds = calcBoundsPriorityRule(problem, measurements.schedule);
-    if ("smt" == string(argv[1])) enc = new SmtEncoder(problem, bounds, &measurements);
-    else if ("sat" == string(argv[1])) enc = new SatEncoder(problem, bounds, &measurements);
-    else {
-        std::cout << "Argument encoder[smt/sat/maxsat] not recognised" << std::endl;
+    if (!solve(argv[1], problem, measurements, enc, std::cout)) {
+        std::cout << "Argument encoder[smt/sat/portfolio/maxsat] not recognised" << std::endl;
         return 1;
     }
-    enc->encode();
-    measurements.t_enc = (long)((clock() - t_start_enc) * 1000 / CLOCKS_PER_SEC);
-
-    if (!measurements.schedule.empty()) {
-        clock_t t_start_search = clock();
-        enc->optimise();
-        measurements.t_search = (long) ((clock() - t_start_search) * 1000 / CLOCKS_PER_SEC);
-    }
-    else {
-        measurements.t_search = 0;
-        measurements.certified = true;
-    }
-
-    enc->printResults();
 
-    delete enc;
     return 0;
 }
@@ -23,12 +23,60 @@ SOFTWARE.
 #include <iostream>
 #include <fstream>
 #include <regex>
-#include <cassert>
+#include <cstring>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "Parser.h"
+#include "InstanceCache.h"
 
 using namespace RcpsptExact;
 
+static inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Returns the token starting at or after p in the line [p, end), and advances p past it
+static string_view nextToken(const char*& p, const char* end) {
+    while (p < end && isSpace(*p)) p++;
+    const char* start = p;
+    while (p < end && !isSpace(*p)) p++;
+    return {start, (size_t)(p - start)};
+}
+
+// Reports that the instance file cannot be parsed
+[[noreturn]] static void invalidInstance(const char* reason) {
+    throw InvalidInstance(reason);
+}
+
+// Scans the next integer in the line [p, end), and advances p past it
+static int nextInt(const char*& p, const char* end) {
+    while (p < end && isSpace(*p)) p++;
+    bool negative = false;
+    if (p < end && *p == '-') {
+        negative = true;
+        p++;
+    }
+    if (p == end || *p < '0' || *p > '9') invalidInstance("missing or malformed integer (is the file truncated?)");
+    int value = 0;
+    while (p < end && *p >= '0' && *p <= '9') value = value * 10 + (*p++ - '0');
+    return negative ? -value : value;
+}
+
+static int toInt(string_view token) {
+    const char* p = token.data();
+    return nextInt(p, token.data() + token.size());
+}
+
+// Gets the integer in token i of a line (used by the ifstream parser)
+static int tokenInt(const vector<string>& tokens, int i) {
+    if (i >= (int)tokens.size()) invalidInstance("missing or malformed integer (is the file truncated?)");
+    return toInt(tokens[i]);
+}
+
 static void tokenize(const string& str, vector<string>& out) {
     out.clear();
     int i = 0;
@@ -58,20 +106,20 @@ Problem Parser::parseProblemInstance(ifstream& input) {
         if (section == 1) continue; // Section 1 does not contain relevant data
 
         tokenize(line, tokens);
+        if (tokens.empty()) continue;
         if (section == 2) {
-            if (tokens.front() == "jobs") njobs = stoi(tokens.back());
-            else if (tokens.front() == "horizon") horizon = stoi(tokens.back());
-            else if (tokens.back() == "R") nresources = stoi(tokens[tokens.size() - 2]);
+            if (tokens.front() == "jobs") njobs = tokenInt(tokens, (int)tokens.size() - 1);
+            else if (tokens.front() == "horizon") horizon = tokenInt(tokens, (int)tokens.size() - 1);
+            else if (tokens.back() == "R" && tokens.size() >= 2) nresources = tokenInt(tokens, (int)tokens.size() - 2);
             continue;
         }
     }
 
-    assert((njobs > -1) && "njobs was not successfully parsed");
-    assert((horizon > -1) && "horizon was not successfully parsed");
-    assert((nresources > -1) && "nresources was not successfully parsed");
+    if (njobs < 0 || horizon < 0 || nresources < 0) invalidInstance("missing number of jobs, horizon or number of resources");
     Problem result(njobs, horizon, nresources);
 
     int currJob = -1, currResource = 0; // Variables used for parsing related consecutive lines
+    int ncapacities = 0; // Number of resources for which the capacities have been parsed
     while (getline(input, line)) {
         if (line.empty()) continue;
         if (line[0] == '*') {
@@ -82,13 +130,14 @@ Problem Parser::parseProblemInstance(ifstream& input) {
         if (section == 3) continue; // Section "PROJECT INFORMATION" does not contain relevant data
 
         tokenize(line, tokens);
+        if (tokens.empty()) continue;
         if (section == 4) { // Section "PRECEDENCE RELATIONS"
             if (tokens.front() == "PRECEDENCE" || tokens.front() == "jobnr.") continue;
-            int job = stoi(tokens.front()) - 1; // Subtract 1 for zero-indexed array indexing
-            int nsucc = stoi(tokens[2]);
+            int job = tokenInt(tokens, 0) - 1; // Subtract 1 for zero-indexed array indexing
+            int nsucc = tokenInt(tokens, 2);
             result.successors[job].reserve(nsucc);
             for (int i = 0; i < nsucc; i++) {
-                int successor = stoi(tokens[3 + i]) - 1;
+                int successor = tokenInt(tokens, 3 + i) - 1;
                 result.successors[job].push_back(successor);
                 result.predecessors[successor].push_back(job);
             }
@@ -98,33 +147,192 @@ Problem Parser::parseProblemInstance(ifstream& input) {
             if (tokens.front()[0] == '-') continue;
             if (tokens.front() == "jobnr.") continue;
             if (currResource == 0 && tokens.size() <= 3) { // This is a dummy job
-                currJob = stoi(tokens.front()) - 1;
-                result.durations.push_back(0);
-                for (int i = 0; i < nresources; i++) result.requests[currJob][i].reserve(0);
+                currJob = tokenInt(tokens, 0) - 1;
+                result.addJob(0);
                 continue;
             }
             if (currResource == 0) { // First line for a job
-                currJob = stoi(tokens.front()) - 1;
-                int duration = stoi(tokens[2]);
-                result.durations.push_back(duration);
-                result.requests[currJob][currResource].reserve(duration);
-                for (int i = 0; i < duration; i++)
-                    result.requests[currJob][currResource].push_back(stoi(tokens[3 + i]));
+                currJob = tokenInt(tokens, 0) - 1;
+                int duration = tokenInt(tokens, 2);
+                result.addJob(duration);
+                int* requests = result.requests(currJob, currResource);
+                for (int i = 0; i < duration; i++) requests[i] = tokenInt(tokens, 3 + i);
             }
             else { // Remaining lines for a job
-                result.requests[currJob][currResource].reserve(result.durations[currJob]);
-                for (int i = 0; i < result.durations[currJob]; i++)
-                    result.requests[currJob][currResource].push_back(stoi(tokens[i]));
+                int* requests = result.requests(currJob, currResource);
+                for (int i = 0; i < result.durations[currJob]; i++) requests[i] = tokenInt(tokens, i);
             }
             currResource = (currResource + 1) % nresources;
         }
         else if (section == 6) { // Section "RESOURCEAVAILABILITIES"
             if ((int)tokens.size() <= 2 * nresources) continue;
-            for (string& token : tokens)
-                result.capacities[currResource].push_back(stoi(token));
+            if ((int)tokens.size() < horizon) invalidInstance("too few resource capacities");
+            int* capacities = result.capacities(currResource);
+            for (int t = 0; t < horizon; t++) capacities[t] = tokenInt(tokens, t);
+            currResource = (currResource + 1) % nresources;
+            ncapacities++;
+        }
+    }
+
+    if ((int)result.durations.size() != njobs || ncapacities != nresources) invalidInstance("file is truncated");
+
+    return result;
+}
+
+static int countTokens(const char* p, const char* end) {
+    int count = 0;
+    while (!nextToken(p, end).empty()) count++;
+    return count;
+}
+
+// Gets the last two tokens in the line [p, end), the first of which may be empty
+static pair<string_view, string_view> lastTokens(const char* p, const char* end) {
+    string_view secondLast, last;
+    for (string_view token = nextToken(p, end); !token.empty(); token = nextToken(p, end)) {
+        secondLast = last;
+        last = token;
+    }
+    return {secondLast, last};
+}
+
+Problem Parser::parseProblemInstance(const string& filePath) {
+    int fd = open(filePath.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0 || st.st_size == 0) {
+        if (fd >= 0) close(fd);
+        ifstream input(filePath);
+        return parseProblemInstance(input);
+    }
+    size_t size = (size_t)st.st_size;
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        ifstream input(filePath);
+        return parseProblemInstance(input);
+    }
+    madvise(mapped, size, MADV_SEQUENTIAL);
+
+    const char* data = (const char*)mapped;
+    try {
+        Problem result = InstanceCache::isCache(data, size)
+                ? InstanceCache::load(data, size)
+                : parseProblemInstance(data, size);
+        munmap(mapped, size);
+        return result;
+    }
+    catch (...) {
+        munmap(mapped, size);
+        throw;
+    }
+}
+
+Problem Parser::parseProblemInstance(const char* data, size_t size) {
+    const char* curr = data;
+    const char* end = data + size;
+
+    int section = 0; // File sections are separated by a line of stars ('*')
+    int njobs = -1, horizon = -1, nresources = -1;
+
+    // Finds the next line [line, lineEnd), and returns false at the end of the buffer
+    const char* line;
+    const char* lineEnd;
+    auto nextLine = [&]() {
+        if (curr >= end) return false;
+        line = curr;
+        lineEnd = (const char*)memchr(curr, '\n', end - curr);
+        if (lineEnd == nullptr) lineEnd = end;
+        curr = lineEnd + 1;
+        return true;
+    };
+
+    while (section <= 2 && nextLine()) {
+        if (line == lineEnd) continue;
+        if (line[0] == '*') {
+            section++;
+            continue;
+        }
+
+        if (section == 1) continue; // Section 1 does not contain relevant data
+
+        if (section == 2) {
+            const char* p = line;
+            string_view first = nextToken(p, lineEnd);
+            if (first.empty()) continue;
+            pair<string_view, string_view> last = lastTokens(line, lineEnd);
+            if (first == "jobs") njobs = toInt(last.second);
+            else if (first == "horizon") horizon = toInt(last.second);
+            else if (last.second == "R") nresources = toInt(last.first);
+            continue;
+        }
+    }
+
+    if (njobs < 0 || horizon < 0 || nresources < 0) invalidInstance("missing number of jobs, horizon or number of resources");
+    Problem result(njobs, horizon, nresources);
+
+    int currJob = -1, currResource = 0; // Variables used for parsing related consecutive lines
+    int ncapacities = 0; // Number of resources for which the capacities have been parsed
+    while (nextLine()) {
+        if (line == lineEnd) continue;
+        if (line[0] == '*') {
+            section++;
+            continue;
+        }
+
+        if (section == 3) continue; // Section "PROJECT INFORMATION" does not contain relevant data
+
+        const char* p = line;
+        string_view first = nextToken(p, lineEnd);
+        if (first.empty()) continue;
+        if (section == 4) { // Section "PRECEDENCE RELATIONS"
+            if (first == "PRECEDENCE" || first == "jobnr.") continue;
+            int job = toInt(first) - 1; // Subtract 1 for zero-indexed array indexing
+            nextInt(p, lineEnd); // Number of modes
+            int nsucc = nextInt(p, lineEnd);
+            result.successors[job].reserve(nsucc);
+            for (int i = 0; i < nsucc; i++) {
+                int successor = nextInt(p, lineEnd) - 1;
+                result.successors[job].push_back(successor);
+                result.predecessors[successor].push_back(job);
+            }
+        }
+        else if (section == 5) { // Section "REQUESTS/DURATIONS"
+            if (first == "REQUESTS/DURATIONS:") continue;
+            if (first[0] == '-') continue;
+            if (first == "jobnr.") continue;
+            if (currResource == 0 && countTokens(line, lineEnd) <= 3) { // This is a dummy job
+                currJob = toInt(first) - 1;
+                result.addJob(0);
+                continue;
+            }
+            if (currResource == 0) { // First line for a job
+                currJob = toInt(first) - 1;
+                nextInt(p, lineEnd); // Mode
+                int duration = nextInt(p, lineEnd);
+                result.addJob(duration);
+                int* requests = result.requests(currJob, currResource);
+                for (int i = 0; i < duration; i++) requests[i] = nextInt(p, lineEnd);
+            }
+            else { // Remaining lines for a job
+                p = line;
+                int* requests = result.requests(currJob, currResource);
+                for (int i = 0; i < result.durations[currJob]; i++) requests[i] = nextInt(p, lineEnd);
+            }
             currResource = (currResource + 1) % nresources;
         }
+        else if (section == 6) { // Section "RESOURCEAVAILABILITIES"
+            if (countTokens(line, lineEnd) <= 2 * nresources) continue;
+            p = line;
+            int* capacities = result.capacities(currResource);
+            int t = 0;
+            for (string_view token = nextToken(p, lineEnd); !token.empty() && t < horizon; token = nextToken(p, lineEnd))
+                capacities[t++] = toInt(token);
+            if (t < horizon) invalidInstance("too few resource capacities");
+            currResource = (currResource + 1) % nresources;
+            ncapacities++;
+        }
     }
 
+    if ((int)result.durations.size() != njobs || ncapacities != nresources) invalidInstance("file is truncated");
+
     return result;
 }
@@ -23,12 +23,24 @@ SOFTWARE.
 #ifndef RCPSPT_HEURISTIC_PARSER_H
 #define RCPSPT_HEURISTIC_PARSER_H
 
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
 #include "Problem.h"
 
 using namespace std;
 
 namespace RcpsptExact {
 
+/**
+ * Exception thrown by Parser when an instance file is malformed or truncated.
+ */
+class InvalidInstance : public runtime_error {
+public:
+    explicit InvalidInstance(const string& reason) : runtime_error("Invalid instance file: " + reason) {}
+};
+
 /**
  * Class containing functions for parsing instances of the RCPSP/t.
  */
@@ -41,8 +53,31 @@ public:
      *
      * @param input the file to read
      * @return the Problem instance containing the parsed data
+     * @throws InvalidInstance if the file is malformed or truncated
      */
     static Problem parseProblemInstance(ifstream& input);
+
+    /**
+     * Parses a .smt file containing an instance of the RCPSP/t into an instance of the Problem class.
+     * The file is memory-mapped and integers are scanned directly from the mapped bytes, without
+     * copying tokens into strings. If the file cannot be mapped, parseProblemInstance(ifstream&) is used instead.
+     * If the file is a binary instance cache (see InstanceCache), the instance is loaded from the cache.
+     *
+     * @param filePath path to the file to read
+     * @return the Problem instance containing the parsed data
+     * @throws InvalidInstance if the file is malformed or truncated (both parsers check the same)
+     */
+    static Problem parseProblemInstance(const string& filePath);
+
+private:
+    /**
+     * Parses a Hartmann (2013) instance from an in-memory buffer (used by the memory-mapped parser).
+     *
+     * @param data pointer to the first byte of the buffer
+     * @param size number of bytes in the buffer
+     * @return the Problem instance containing the parsed data
+     */
+    static Problem parseProblemInstance(const char* data, size_t size);
 };
 }
 
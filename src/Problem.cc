@@ -21,6 +21,7 @@ SOFTWARE.
 **************************************************************************************************/
 
 #include "Problem.h"
+#include "utils/TemporalAnalysis.h"
 
 using namespace RcpsptExact;
 
@@ -36,18 +37,26 @@ Problem::Problem(int njobs, int horizon, int nresources)
 
     durations.reserve(njobs);
 
-    requests.reserve(njobs);
-    for (int i = 0; i < njobs; i++) {
-        requests.emplace_back();
-        requests.back().reserve(nresources);
-        for (int j = 0; j < nresources; j++) requests.back().emplace_back();
-    }
+    requestOffsets.reserve(njobs + 1);
+    requestOffsets.push_back(0);
 
-    capacities.reserve(nresources);
-    for (int i = 0; i < nresources; i++) {
-        capacities.emplace_back();
-        capacities.back().reserve(horizon);
-    }
+    capacityData.resize(nresources * horizon, 0);
 }
 
 Problem::~Problem() = default;
+
+void Problem::addJob(int duration) {
+    durations.push_back(duration);
+    requestOffsets.push_back(requestOffsets.back() + nresources * duration);
+    requestData.resize(requestOffsets.back(), 0);
+}
+
+const TemporalAnalysis& Problem::temporal() const {
+    shared_ptr<const TemporalAnalysis> curr = atomic_load(&temporalAnalysis);
+    if (curr == nullptr) {
+        // If another thread finished building it first, that analysis is kept and this one is discarded
+        auto built = make_shared<const TemporalAnalysis>(*this);
+        if (atomic_compare_exchange_strong(&temporalAnalysis, &curr, built)) curr = built;
+    }
+    return *curr;
+}
@@ -23,14 +23,23 @@ SOFTWARE.
 #ifndef RCPSPT_HEURISTIC_PROBLEM_H
 #define RCPSPT_HEURISTIC_PROBLEM_H
 
+#include <memory>
 #include <vector>
 
 using namespace std;
 
 namespace RcpsptExact {
 
+class TemporalAnalysis;
+
 /**
  * Class representing an instance of the RCPSP/t.
+ *
+ * Requests and capacities are stored in flat arrays, so that scans over a time window are contiguous:
+ *  - requests: for each activity one block of nresources rows, each row holding durations[i] values (CSR-style,
+ *    indexed through per-activity offsets)
+ *  - capacities: one row of horizon values per resource, stored consecutively (time steps for which no capacity
+ *    was given are padded with 0)
  */
 class Problem {
 public:
@@ -47,8 +56,40 @@ public:
     vector<vector<int>> successors;       // List of successors for each activity
     vector<vector<int>> predecessors;     // List of predecessors for each activity (for backwards traversal of the precedence graph)
     vector<int> durations;                // Duration for each activity
-    vector<vector<vector<int>>> requests; // Request per time step, per resource, per activity
-    vector<vector<int>> capacities;       // Capacity for each time step, per resource
+
+    /**
+     * Adds the next activity with the given duration, and allocates its request rows (initialised to 0).
+     * Activities must be added in order of their index.
+     *
+     * @param duration duration of the activity
+     */
+    void addJob(int duration);
+
+    /**
+     * Gets the request row of activity i for resource k, containing one value per time step of its duration.
+     */
+    inline const int* requests(int i, int k) const { return requestData.data() + requestOffsets[i] + k * durations[i]; }
+    inline int* requests(int i, int k) { return requestData.data() + requestOffsets[i] + k * durations[i]; }
+
+    /**
+     * Gets the capacity row of resource k, containing one value per time step of the horizon.
+     * The rows of all resources are consecutive, so capacities(0) points to nresources * horizon values.
+     */
+    inline const int* capacities(int k) const { return capacityData.data() + k * horizon; }
+    inline int* capacities(int k) { return capacityData.data() + k * horizon; }
+
+    /**
+     * Gets the temporal analysis of this instance (feasible start times and time windows), which is built on first use
+     * and then shared by the heuristic and all encoders. The instance data should not be changed after that.
+     * Safe to call from multiple threads.
+     */
+    const TemporalAnalysis& temporal() const;
+
+private:
+    vector<int> requestOffsets; // Offset of the first request row of each activity in requestData
+    vector<int> requestData;    // Request per time step, per resource, per activity
+    vector<int> capacityData;   // Capacity for each time step, per resource
+    mutable shared_ptr<const TemporalAnalysis> temporalAnalysis; // Built on first use (accessed atomically)
 };
 }
 
@@ -20,9 +20,12 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 **************************************************************************************************/
 
-#include <queue>
+#include <algorithm>
+#include <cstdlib>
 
 #include "Encoder.h"
+#include "ads/PBEncodingCache.h"
+#include "../utils/TemporalAnalysis.h"
 
 using namespace RcpsptExact;
 
@@ -38,74 +41,134 @@ Encoder::Encoder(Problem& p, pair<int,int> bounds)
 Encoder::~Encoder() = default;
 
 bool Encoder::calcTimeWindows() {
-    queue<int> q; // Use a queue for breadth-first traversal of the precedence graph
-
-    // Calculate earliest feasible finish (close) times, using the definition from Hartmann (2013) (reference in README.md)
-    for (int i = 0; i < problem.njobs; i++) EC[i] = 0;
-    q.push(0);
-    while(!q.empty()) {
-        int job = q.front();
-        q.pop();
-        int duration = problem.durations[job];
-        // Move finish until it is feasible considering resource constraints
-        bool feasibleFinal = false;
-        while (!feasibleFinal) {
-            bool feasible = true;
-            for (int k = 0; feasible && k < problem.nresources; k++) {
-                for (int t = duration - 1; feasible && t >= 0; t--) {
-                    if (problem.requests[job][k][t] > problem.capacities[k][EC[job] - duration + t]) {
-                        feasible = false;
-                        EC[job]++;
-                    }
+    // The windows are shared with the heuristic and other encoders of the instance, so they are only calculated once per UB
+    shared_ptr<const TimeWindows> windows = problem.temporal().windows(UB);
+    ES = windows->ES;
+    EC = windows->EC;
+    LS = windows->LS;
+    LC = windows->LC;
+    return windows->feasible;
+}
+
+void Encoder::buildResourceConstrs(PBConstrList& constrs) const {
+    // Sweep over time, keeping the activities i with t in RTW(i) = [ES[i], LC[i]) in ascending order: each activity is
+    // added at ES[i] and removed at LC[i]. For a running activity, only the offsets e with t-e in STW(i) are visited
+    vector<vector<int>> starting(UB), ending(UB); // Activities of which the RTW starts/ends at each time step
+    for (int i = 0; i < problem.njobs; i++) {
+        if (ES[i] >= LC[i] || ES[i] >= UB) continue;
+        starting[ES[i]].push_back(i);
+        if (LC[i] < UB) ending[LC[i]].push_back(i);
+    }
+    vector<int> running;
+    for (int k = 0; k < problem.nresources; k++) {
+        running.clear();
+        for (int t = 0; t < UB; t++) {
+            for (int i : ending[t]) running.erase(lower_bound(running.begin(), running.end(), i));
+            for (int i : starting[t]) running.insert(lower_bound(running.begin(), running.end(), i), i);
+            constrs.begin(problem.capacities(k)[t]);
+            for (int i : running) {
+                const int* requests = problem.requests(i, k);
+                int first = max(0, t - LS[i]), last = min(problem.durations[i] - 1, t - ES[i]);
+                for (int e = first; e <= last; e++) { // t-e in STW(i)
+                    if (requests[e] == 0) continue;
+                    constrs.addTerm(requests[e], {i, -ES[i] + t-e});
                 }
             }
-            if (feasible) feasibleFinal = true;
-            if (EC[job] > UB) return false;
-        }
-        // Update finish times, and enqueue successors
-        for (int succ : problem.successors[job]) {
-            int c = EC[job] + problem.durations[succ];
-            if (c > EC[succ]) EC[succ] = c; // Use maximum values, because we are interested in critical paths
-            q.push(succ); // Enqueue successor
+            constrs.end();
         }
     }
+}
+
+shared_ptr<ResourceClauses> Encoder::generateResourceClauses() {
+    if (!problem.temporal().windows(UB)->feasible) return nullptr;
+    shared_ptr<ResourceClauses> result = make_shared<ResourceClauses>();
+    result->stats = generateClauses(result->clauses, false);
+    return result;
+}
+
+ClauseStats Encoder::generateClauses(ClauseBuffer& clauses, bool precedences, bool resources) {
+    ClauseStats stats;
+    firstStartVar.assign(problem.njobs, 0);
+    firstProcessVar.assign(problem.njobs, 0);
+    for (int i = 0; i < problem.njobs; i++) firstStartVar[i] = clauses.newVars(LS[i] - ES[i] + 1); // t in STW(i)
+    if (precedences) {
+        for (int i = 0; i < problem.njobs; i++) firstProcessVar[i] = clauses.newVars(LC[i] - ES[i] + 1); // t in RTW(i)
+    }
+
+    if (precedences) {
+        // Consistency clauses
+        for (int i = 0; i < problem.njobs; i++) {
+            for (int s = ES[i]; s <= LS[i]; s++) { // s in STW(i)
+                for (int t = s; t < s + problem.durations[i]; t++) clauses.add({-startVar(i, s), processVar(i, t)});
+            }
+        }
 
-    // Calculate latest feasible start times, again using the definition from Hartmann (2013) (reference in README.md)
-    for (int i = 0; i < problem.njobs; i++) LS[i] = UB;
-    q.push(problem.njobs - 1);
-    while(!q.empty()) {
-        int job = q.front();
-        q.pop();
-        int duration = problem.durations[job];
-        // Move start until it is feasible considering resource constraints
-        bool feasibleFinal = false;
-        while (!feasibleFinal) {
-            bool feasible = true;
-            for (int k = 0; feasible && k < problem.nresources; k++) {
-                for (int t = 0; feasible && t < duration; t++) {
-                    if (problem.requests[job][k][t] > problem.capacities[k][LS[job] + t]) {
-                        feasible = false;
-                        LS[job]--;
-                    }
+        // Job 0 starts at 0
+        clauses.add({startVar(0, 0)});
+
+        // Precedence clauses
+        vector<int> clause;
+        for (int i = 1; i < problem.njobs; i++) {
+            for (int j : problem.predecessors[i]) {
+                for (int s = ES[i]; s <= LS[i]; s++) { // s in STW(i)
+                    clause.assign(1, -startVar(i, s));
+                    // Also check t <= LS[j], in addition to the definition by Horbach, because for RCPSP/t resource constraints can cause 'gaps' between activities (j,i)
+                    // Another difference: t <= ES[i]-durations[j] was replaced by t <= s-durations[j], the former definition was likely a mistake in the paper
+                    for (int t = ES[j]; t <= s-problem.durations[j] && t <= LS[j]; t++) clause.push_back(startVar(j, t));
+                    clauses.add(clause.begin(), clause.end());
                 }
             }
-            if (feasible) feasibleFinal = true;
-            if (LS[job] < 0) return false;
         }
-        // Update start times, and enqueue predecessors
-        for (int pred : problem.predecessors[job]) {
-            int s = LS[job] - problem.durations[pred];
-            if (s < LS[pred]) LS[pred] = s; // Use minimum values for determining critical paths
-            q.push(pred); // Enqueue predecessor
+
+        // Start clauses
+        for (int i = 1; i < problem.njobs; i++) {
+            clause.clear();
+            for (int s = ES[i]; s <= LS[i]; s++) clause.push_back(startVar(i, s)); // s in STW(i)
+            clauses.add(clause.begin(), clause.end());
+        }
+
+        // Add redundant clauses that should improve runtime
+        for (int i = 0; i < problem.njobs; i++) {
+            for (int c = EC[i]; c < LC[i]; c++)
+                clauses.add({-processVar(i, c), processVar(i, c+1), startVar(i, c-problem.durations[i]+1)});
         }
     }
 
-    for (int i = 0; i < problem.njobs; i++) {
-        ES[i] = EC[i] - problem.durations[i];
-        LC[i] = LS[i] + problem.durations[i];
+    if (!resources) {
+        clauses.deduplicate();
+        return stats;
     }
 
-    return true;
-}
+    // Add resource constraints
+    PBConstrList pbConstrs;
+    buildResourceConstrs(pbConstrs);
 
-#include "Encoder.h"
+    // Encode each PB constraint, constraints with the same constants and K share their encoding (see PBEncodingCache).
+    // The encodings are constructed in parallel, and then the clauses are added in the order of the constraints
+    PBEncodingCache cache;
+    vector<const PBEncoding*> encodings = cache.getAll(pbConstrs, pbEncoding, nthreads);
+    vector<int> clause;
+    for (int c = 0; c < pbConstrs.size(); c++) {
+        PBConstr C = pbConstrs[c];
+        const PBEncoding& encoding = *encodings[c];
+        if (encoding.nClauses == 0) continue; // Skip if the constraint cannot be falsified
+        stats.nPB[(int)encoding.type]++;
+        int firstAux = clauses.newVars(encoding.nAux);
+
+        // Add the clauses of the encoding, in which the variables of the terms are the start variables y_(i,t)
+        for (int lit : encoding.lits) {
+            if (lit == 0) {
+                clauses.add(clause.begin(), clause.end());
+                clause.clear();
+                continue;
+            }
+            int v = abs(lit);
+            v = v <= encoding.nTerms ? startVar(C.var(v-1).first, ES[C.var(v-1).first] + C.var(v-1).second)
+                                     : firstAux + v - encoding.nTerms - 1;
+            clause.push_back(lit > 0 ? v : -v);
+        }
+    }
+    stats.pbPeak = cache.highWater();
+    clauses.deduplicate();
+    return stats;
+}
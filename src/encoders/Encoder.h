@@ -24,10 +24,30 @@ SOFTWARE.
 #define RCPSPT_EXACT_ENCODER_H
 
 #include "../Problem.h"
+#include "ads/ClauseBuffer.h"
+#include "ads/PBEncoding.h"
+#include "../utils/ParallelFor.h"
 #include "../utils/ValidityChecker.h"
 
 namespace RcpsptExact {
 
+/**
+ * Statistics of the clauses that are generated by Encoder::generateClauses.
+ */
+struct ClauseStats {
+    int nPB[PB_N_ENCODINGS] = {}; // Number of resource constraints encoded with each PBEncodingType
+    size_t pbPeak = 0; // Peak memory in bytes used for the decision diagram of a single PB constraint
+};
+
+/**
+ * Clauses of the resource constraints only, generated once and shared by encoders with the same time windows (see
+ * Encoder::generateResourceClauses).
+ */
+struct ResourceClauses {
+    ClauseBuffer clauses;
+    ClauseStats stats;
+};
+
 /**
  * Abstract base class for all encoders.
  */
@@ -42,6 +62,22 @@ public:
      */
     bool calcTimeWindows();
 
+    /**
+     * @return true if the other encoder has the same bounds and time windows, so that it has the same resource constraints
+     */
+    bool sharesTimeWindows(const Encoder& other) const { return UB == other.UB && ES == other.ES && LS == other.LS; }
+
+    /**
+     * Generates the clauses of the resource constraints for the current time windows, as generateClauses does without
+     * precedences, so that they can be shared with other encoders (see sharesTimeWindows).
+     *
+     * @return the clauses, nullptr if the time windows are infeasible
+     */
+    shared_ptr<ResourceClauses> generateResourceClauses();
+
+    int nthreads = defaultThreadCount(); // Number of worker threads used for encoding
+    PBEncodingType pbEncoding = PBEncodingType::AUTO; // Encoding of the resource constraints into clauses
+
 protected:
     Encoder(Problem& p, pair<int,int> bounds);
 
@@ -50,6 +86,43 @@ protected:
     int LB, UB; // The lower and upper bounds for the makespan that are currently being used
 
     vector<int> ES, EC, LS, LC; // For each activity: earliest start, earliest close, latest start, and latest close time
+
+    /**
+     * Determines the PB constraints for the resources: for each resource k and time step t < UB, the sum of the requests
+     * of the activities that could be running at t is at most the capacity. A term q*y_(i,s) is added for each start time
+     * s in STW(i) for which activity i would be running at t with request q > 0 (s is stored relative to ES[i]).
+     *
+     * @param constrs list to add the constraints to (constraints without terms are left out)
+     */
+    void buildResourceConstrs(PBConstrList& constrs) const;
+
+    /**
+     * Generates the clauses of the SAT encoding for the current time windows, which are shared by the backends (see
+     * ClauseSink). The variables are numbered as follows: first the start variables y_(i,t) for t in STW(i), activity
+     * by activity, then the process variables x_(i,t) for t in RTW(i) (only with precedences), and then the auxiliary
+     * variables of the resource constraints. Duplicate clauses are removed.
+     *
+     * @param clauses buffer to add the clauses to
+     * @param precedences whether to add the process variables and the precedence clauses, following Horbach (2010)
+     * (reference in README.md), or only the resource constraints
+     * @param resources whether to add the resource constraints (false if these have been generated separately, see
+     * generateResourceClauses)
+     * @return statistics of the clauses
+     */
+    ClauseStats generateClauses(ClauseBuffer& clauses, bool precedences, bool resources = true);
+
+    /**
+     * @return variable y_(i,t) in the clauses of generateClauses, for t in STW(i)
+     */
+    int startVar(int i, int t) const { return firstStartVar[i] + t - ES[i]; }
+
+    /**
+     * @return variable x_(i,t) in the clauses of generateClauses, for t in RTW(i)
+     */
+    int processVar(int i, int t) const { return firstProcessVar[i] + t - ES[i]; }
+
+private:
+    vector<int> firstStartVar, firstProcessVar; // Variable y_(i,ES[i]) and x_(i,ES[i]) for each activity
 };
 }
 
@@ -0,0 +1,107 @@
+/*****************************************************************************[PortfolioEncoder.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "PortfolioEncoder.h"
+
+using namespace RcpsptExact;
+
+PortfolioEncoder::PortfolioEncoder(Problem &p, pair<int, int> bounds, Measurements* m, int nthreads)
+        : YicesEncoder(p, bounds, m) {
+    this->nthreads = nthreads;
+    ctx = nullptr;
+    smtMeasurements.file = satMeasurements.file = m->file;
+    smtMeasurements.schedule = satMeasurements.schedule = m->schedule;
+
+    thread smtThread([&]() { smt = new SmtEncoder(p, bounds, &smtMeasurements, max(1, nthreads - 1)); }); // The SAT side preprocesses on this thread
+    sat = new SatEncoder(p, bounds, &satMeasurements);
+    smtThread.join();
+    measurements->t_preprocess = max(smtMeasurements.t_preprocess, satMeasurements.t_preprocess); // Done concurrently
+    smt->shared = &bound;
+    sat->shared = &bound;
+}
+
+PortfolioEncoder::~PortfolioEncoder() {
+    delete smt;
+    delete sat;
+}
+
+void PortfolioEncoder::encode() {
+    smt->pbEncoding = sat->pbEncoding = pbEncoding;
+    // Both sides have the same resource constraints (the time windows are shared per bound), so their clauses are
+    // generated only once, with all threads
+    if (sat->sharesTimeWindows(*smt)) {
+        sat->nthreads = nthreads;
+        smt->resourceClauses = sat->resourceClauses = sat->generateResourceClauses();
+    }
+    smt->nthreads = sat->nthreads = max(1, nthreads / 2); // Both sides encode at the same time
+    thread smtThread([&]() { smt->encode(); });
+    sat->encode();
+    smtThread.join();
+
+    measurements->enc_n_boolv = smtMeasurements.enc_n_boolv + satMeasurements.enc_n_boolv;
+    measurements->enc_n_intv = smtMeasurements.enc_n_intv + satMeasurements.enc_n_intv;
+    measurements->enc_n_clause = smtMeasurements.enc_n_clause + satMeasurements.enc_n_clause;
+    measurements->enc_bdd_peak = max(smtMeasurements.enc_bdd_peak, satMeasurements.enc_bdd_peak);
+    for (int t = 0; t < PB_N_ENCODINGS; t++) measurements->enc_n_pb[t] = smtMeasurements.enc_n_pb[t] + satMeasurements.enc_n_pb[t];
+}
+
+vector<int> PortfolioEncoder::solve() {
+    return sat->solve();
+}
+
+void PortfolioEncoder::optimise() {
+    optimising = true;
+    atomic<int> running(2);
+    thread smtThread([&]() { smt->optimise(); running--; });
+    thread satThread([&]() { sat->optimise(); running--; });
+
+    // Once one side is done (or the search is interrupted), keep stopping the other side until it has returned:
+    // a single stop request is lost when it arrives just before the other side starts its next check
+    while (running > 0) {
+        if (bound.certified || interrupted) {
+            smt->interrupt();
+            sat->interrupt();
+        }
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    smtThread.join();
+    satThread.join();
+    optimising = false;
+
+    // The certified result holds for the best solution found by either side (it was shared as upper bound)
+    measurements->certified = smtMeasurements.certified || satMeasurements.certified;
+    if (smtMeasurements.schedule.empty() || satMeasurements.schedule.empty()) measurements->schedule.clear();
+    else if (smtMeasurements.schedule.back() <= satMeasurements.schedule.back()) measurements->schedule = smtMeasurements.schedule;
+    else measurements->schedule = satMeasurements.schedule;
+}
+
+bool PortfolioEncoder::searching() const {
+    return optimising;
+}
+
+void PortfolioEncoder::interrupt() {
+    interrupted = true;
+}
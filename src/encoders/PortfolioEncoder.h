@@ -0,0 +1,89 @@
+/******************************************************************************[PortfolioEncoder.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#ifndef RCPSPT_EXACT_PORTFOLIOENCODER_H
+#define RCPSPT_EXACT_PORTFOLIOENCODER_H
+
+#include <atomic>
+
+#include "SmtEncoder.h"
+#include "SatEncoder.h"
+
+using namespace std;
+
+namespace RcpsptExact {
+
+/**
+ * Encoder that races the SMT and SAT encoders on the same problem instance, each on its own thread and Yices context.
+ * Whenever one of them finds a better solution, its makespan is used as upper bound by the other (see SharedBound).
+ * As soon as one of them certifies the best solution optimal (or the instance infeasible), the other one is stopped.
+ *
+ * Since both encoders use Yices at the same time, this requires Yices to be built with thread safety enabled.
+ * Time measurements of this encoder should be made in wall-clock time (see Measurements::wallClock).
+ */
+class PortfolioEncoder : public YicesEncoder {
+public:
+    /**
+     * Constructor, which already constructs (and so preprocesses) both encoders.
+     *
+     * @param nthreads number of worker threads for preprocessing and encoding, shared by both encoders
+     */
+    PortfolioEncoder(Problem& p, pair<int,int> bounds, Measurements* m, int nthreads = defaultThreadCount());
+    // Destructor
+    ~PortfolioEncoder();
+
+    /**
+     * Encodes the problem instance with both encoders concurrently.
+     */
+    void encode() override;
+
+    /**
+     * Calls Yices to solve the feasibility problem with the SAT encoding.
+     *
+     * @return vector with the start time for each activity, will be empty if problem is unsatisfiable
+     */
+    vector<int> solve() override;
+
+    /**
+     * Finds the optimal solution by running the optimisation procedures of both encoders concurrently.
+     * The best solution found by either of them is stored in the Measurements struct.
+     *
+     * While Yices is searching an interruption signal (SIGTERM) can be sent, stopping the search of both encoders.
+     */
+    void optimise() override;
+
+    bool searching() const override;
+    void interrupt() override;
+
+private:
+    Measurements smtMeasurements;
+    Measurements satMeasurements;
+    SmtEncoder* smt;
+    SatEncoder* sat;
+    SharedBound bound;
+
+    atomic<bool> optimising{false}; // Whether optimise() is running
+    atomic<bool> interrupted{false}; // Whether interrupt() was called during optimise()
+};
+}
+
+#endif //RCPSPT_EXACT_PORTFOLIOENCODER_H
@@ -26,14 +26,14 @@ SOFTWARE.
 #include <queue>
 
 #include "SatEncoder.h"
-#include "ads/BDD.h"
-#include "ads/PBConstr.h"
 
 using namespace RcpsptExact;
 
 SatEncoder::SatEncoder(Problem &p, pair<int, int> bounds, Measurements* m)
         : YicesEncoder(p, bounds, m) {
+    long t_start_preprocess = measurements->now();
     preprocessFeasible = preprocess();
+    measurements->t_preprocess = measurements->now() - t_start_preprocess;
     initialise();
 }
 
@@ -42,7 +42,7 @@ bool SatEncoder::preprocess() {
 }
 
 void SatEncoder::initialise() {
-    yices_init();
+    initYices();
 
     // Create the variables
 
@@ -83,152 +83,32 @@ void SatEncoder::encode() {
 
     if (!preprocessFeasible) {
 //        std::cout << "Preprocessing found instance to be infeasible" << std::endl;
-        formula = yices_false();
+        yices_assert_formula(ctx, yices_false());
         return;
     }
 
-    // Add precedence constraints
-
-    vector<term_t> precedenceConstrs;
-
-    // Consistency clauses
-    for (int i = 0; i < problem.njobs; i++) {
-        for (int s = ES[i]; s <= LS[i]; s++) { // s in STW(i)
-            for (int t = s; t < s + problem.durations[i]; t++) {
-                precedenceConstrs.push_back(yices_or2(yices_not(y[i][-ES[i] + s]), x[i][-ES[i] + t]));
-                measurements->enc_n_clause++;
-            }
-        }
-    }
-
-    // Job 0 starts at 0
-    precedenceConstrs.push_back(y[0][0]);
-    measurements->enc_n_clause++;
-
-    // Precedence clauses
-    for (int i = 1; i < problem.njobs; i++) {
-        for (int j : problem.predecessors[i]) {
-            for (int s = ES[i]; s <= LS[i]; s++) { // s in STW(i)
-                vector<term_t> clause;
-                clause.push_back(yices_not(y[i][-ES[i] + s]));
-                // Also check t <= LS[j], in addition to the definition by Horbach, because for RCPSP/t resource constraints can cause 'gaps' between activities (j,i)
-                // Another difference: t <= ES[i]-durations[j] was replaced by t <= s-durations[j], the former definition was likely a mistake in the paper
-                for (int t = ES[j]; t <= s-problem.durations[j] && t <= LS[j]; t++) {
-                    clause.push_back(y[j][-ES[j] + t]);
-                }
-                precedenceConstrs.push_back(yices_or(clause.size(), &clause.front()));
-                measurements->enc_n_clause++;
-            }
-        }
-    }
-
-    // Start clauses
-    for (int i = 1; i < problem.njobs; i++) {
-        vector<term_t> clause;
-        for (int s = ES[i]; s <= LS[i]; s++) { // s in STW(i)
-            clause.push_back(y[i][-ES[i] + s]);
-        }
-        precedenceConstrs.push_back(yices_or(clause.size(), &clause.front()));
-        measurements->enc_n_clause++;
-    }
-
-    // Add redundant clauses that should improve runtime
-    for (int i = 0; i < problem.njobs; i++) {
-        for (int c = EC[i]; c < LC[i]; c++) {
-            precedenceConstrs.push_back(yices_or3(yices_not(x[i][-ES[i] + c]), x[i][-ES[i] + c+1], y[i][-ES[i] + c-problem.durations[i]+1]));
-            measurements->enc_n_clause++;
-        }
-    }
-
-    // Add resource constraints
-
-    vector<term_t> resourceConstrs;
-
-    // List of pseudo-boolean (PB) constraints
-    vector<PBConstr> pbConstrs;
-
-    // Determine PB constraints
-    int q_i;
-    for (int k = 0; k < problem.nresources; k++) {
-        for (int t = 0; t < UB; t++) {
-            pbConstrs.emplace_back(problem.capacities[k][t]);
-            for (int i = 0; i < problem.njobs; i++) {
-                if (t < ES[i] || t >= LC[i]) continue; // only consider i if t in RTW(i)
-                for (int e = 0; e < problem.durations[i]; e++) {
-                    if (t-e < ES[i] || t-e > LS[i]) continue; // only consider e if t-e in STW(i)
-                    q_i = problem.requests[i][k][e];
-                    if (q_i == 0) continue;
-                    pbConstrs.back().addTerm(q_i, {i, -ES[i] + t-e});
-                }
-            }
-            if (pbConstrs.back().nTerms() == 0) pbConstrs.pop_back();
-        }
-    }
-
-    // Encode each PB constraint
-    for (const PBConstr& C : pbConstrs) {
-        // Construct an ROBDD (Reduced Ordered BDD), following Algorithm 1 and Example 24: BDD-1 from the paper by I. Abío et al. (2012) (reference in README.md)
-        BDD falseNode(false);
-        BDD trueNode(true);
-        vector<LSet> L;
-        for (int i = 0; i <= C.nTerms(); i++) {
-            int constsSum = 0;
-            for (int j = i; j < C.nTerms(); j++) constsSum += C.constant(j);
-            L.push_back(LSet({constsSum,INT32_MAX/2}, &trueNode));
-            L.back().insert({INT32_MIN/2, -1}, &falseNode);
-        }
-        pair<pair<int,int>,BDD*> result = BDD::BDDConstruction(0, C, C.K, L);
-        for (LSet& s : L) s.deleteTree();
-        BDD* robdd = result.second;
-        vector<BDD*> nodes;
-        int auxRoot = robdd->flatten(nodes);
-
-        // Add SAT clauses based on the ROBDD, following Example 24: BDD-1 from the paper by I. Abío et al. (2012) (reference in README.md)
-        int auxTerminalF = -1;
-        int auxTerminalT = -1;
-        for (int i = 0; i < (int)nodes.size(); i++) {
-            if (nodes[i]->terminal()) {
-                if (nodes[i]->terminalValue()) auxTerminalT = i;
-                else auxTerminalF = i;
-            }
-        }
-        if (auxTerminalF == -1) continue; // Skip if the constraint cannot be falsified
-        int* measure_bools = &(measurements->enc_n_boolv); // Keep track of the number of boolean variables that is being created
-        for (BDD* node : nodes) {
-            if (node->terminal()) continue;
-            term_t selector = y[node->selector.first][node->selector.second];
-            // Add two clauses
-            resourceConstrs.push_back(yices_or2(node->fBranch->getAuxYices(measure_bools), yices_not(
-                    node->getAuxYices(measure_bools))));
-            resourceConstrs.push_back(yices_or3(node->tBranch->getAuxYices(measure_bools), yices_not(selector), yices_not(
-                    node->getAuxYices(measure_bools))));
-            measurements->enc_n_clause += 2;
-        }
-        // Add three unary clauses
-        resourceConstrs.push_back(nodes[auxRoot]->getAuxYices(measure_bools));
-        resourceConstrs.push_back(yices_not(nodes[auxTerminalF]->getAuxYices(measure_bools)));
-        resourceConstrs.push_back(nodes[auxTerminalT]->getAuxYices(measure_bools));
-        measurements->enc_n_clause += 3;
-
-        for (BDD* node : nodes) if (!node->terminal()) delete node;
-    }
-
-    term_t f_precedence = yices_and(precedenceConstrs.size(), &precedenceConstrs.front());
-    term_t f_resource = yices_and(resourceConstrs.size(), &resourceConstrs.front());
-    formula = yices_and2(f_precedence, f_resource);
+    // Generate the clauses for the precedence and resource constraints (shared with WcnfEncoder), and assert them.
+    // The resource clauses may have been generated already (see PortfolioEncoder)
+    ClauseBuffer clauses;
+    ClauseStats stats = generateClauses(clauses, true, resourceClauses == nullptr);
+    vector<term_t> vars = clauseTerms(clauses, y, x);
+    YicesClauseSink sink(ctx, vars);
+    clauses.emit(sink);
+    sink.flush();
+    measurements->enc_n_clause += clauses.size();
+    if (resourceClauses != nullptr) stats = assertResourceClauses(y);
+    for (int t = 0; t < PB_N_ENCODINGS; t++) measurements->enc_n_pb[t] += stats.nPB[t];
+    measurements->enc_bdd_peak = (long)stats.pbPeak;
+
+    // The terms that were only needed for building the clauses can be deleted now that they have been asserted
+    collectGarbage(vars);
 }
 
 vector<int> SatEncoder::solve() {
     vector<int> solution;
 
-    // Pass formula to Yices
+    // The formula was already asserted by encode()
     int32_t code;
-    code = yices_assert_formula(ctx, formula);
-    if (code < 0) {
-        std::cerr << "Assert failed: code = " << code << ", error = " << yices_error_code() << std::endl;
-        yices_print_error(stderr);
-    }
-
     switch (yices_check_context(ctx, NULL)) {
         case STATUS_SAT: {
             std::cout << "Satisfiable" << std::endl;
@@ -285,11 +165,7 @@ void SatEncoder::optimise() {
     // This optimisation procedure was inspired by the paper by M. Bofill et al. (2020) (reference in README.md)
 
     int32_t code, v;
-    code = yices_assert_formula(ctx, formula);
-    if (code < 0) {
-        std::cerr << "Assert failed: code = " << code << ", error = " << yices_error_code() << std::endl;
-        yices_print_error(stderr);
-    }
+    vector<term_t> bound;
     smt_status_t status = yices_check_context(ctx, NULL);
     model_t* model;
     int UB_old;
@@ -322,7 +198,7 @@ void SatEncoder::optimise() {
             yices_free_model(model);
         }
         UB_old = UB;
-        UB = measurements->schedule.back() - 1;
+        UB = nextUB(measurements->schedule.back());
     }
     else if (status == STATUS_INTERRUPTED) {
 //        std::cout << "Search was interrupted" << std::endl;
@@ -330,18 +206,21 @@ void SatEncoder::optimise() {
     }
     else if (status == STATUS_UNSAT) {
         measurements->schedule.clear();
-        measurements->certified = true;
+        certify();
         return;
     }
     else {
         std::cerr << "Unknown status " << status << " when checking satisfiability" << std::endl;
         return;
     }
-    while (status == STATUS_SAT && UB >= LB) {
+    while (status == STATUS_SAT && UB >= LB && !stopRequested()) {
 //        std::cout << "Current makespan: " << measurements->schedule.back() << std::endl; // line for debugging
+        // Only the new bound is asserted, as unit clauses that forbid activity n+1 to start after UB. The context
+        // keeps everything that was asserted and learned before, so the cost does not grow with the iterations
+        bound.clear();
         for (int t = UB; t < UB_old; t++)
-            formula = yices_and2(formula, yices_not(y.back()[-ES.back() + t + 1]));
-        code = yices_assert_formula(ctx, formula);
+            bound.push_back(yices_not(y.back()[-ES.back() + t + 1]));
+        code = yices_assert_formulas(ctx, bound.size(), bound.data());
         if (code < 0) {
             std::cerr << "Assert failed: code = " << code << ", error = " << yices_error_code() << std::endl;
             yices_print_error(stderr);
@@ -376,7 +255,7 @@ void SatEncoder::optimise() {
                 yices_free_model(model);
             }
             UB_old = UB;
-            UB = measurements->schedule.back() - 1;
+            UB = nextUB(measurements->schedule.back());
         }
         else if (status == STATUS_INTERRUPTED) {
 //            std::cout << "Search was interrupted" << std::endl;
@@ -388,5 +267,5 @@ void SatEncoder::optimise() {
         }
     }
 
-    if (status == STATUS_UNSAT || UB < LB) measurements->certified = true;
+    if (status == STATUS_UNSAT || UB < LB) certify();
 }
@@ -41,11 +41,11 @@ public:
     // Destructor
     ~SatEncoder() {
         yices_free_context(ctx);
-        yices_exit();
+        exitYices();
     }
 
     /**
-     * Encodes the problem instance into CNF and stores the result in the 'formula' field.
+     * Encodes the problem instance into CNF and asserts the result into the Yices context.
      */
     void encode() override;
 
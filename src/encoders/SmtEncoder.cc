@@ -26,26 +26,64 @@ SOFTWARE.
 #include <queue>
 
 #include "SmtEncoder.h"
-#include "ads/BDD.h"
-#include "ads/PBConstr.h"
+#include "../utils/EnergyProfile.h"
+#include "../utils/ParallelFor.h"
 
 using namespace RcpsptExact;
 
-SmtEncoder::SmtEncoder(Problem &p, pair<int, int> bounds, Measurements* m)
+SmtEncoder::SmtEncoder(Problem &p, pair<int, int> bounds, Measurements* m, int nthreads)
         : YicesEncoder(p, bounds, m) {
+    this->nthreads = nthreads;
+    long t_start_preprocess = measurements->now();
     preprocessFeasible = preprocess();
+    measurements->t_preprocess = measurements->now() - t_start_preprocess;
     initialise();
 }
 
 void SmtEncoder::floydWarshall() {
-    // Floyd-Warshall algorithm (https://en.wikipedia.org/wiki/Floyd-Warshall_algorithm)
-    for (int k = 0; k < problem.njobs; k++) {
-        for (int i = 0; i < problem.njobs; i++) {
-            for (int j = 0; j < problem.njobs; j++) {
-                if (l[i][k] + l[k][j] < l[i][j])
-                    l[i][j] = l[i][k] + l[k][j];
+    // Blocked Floyd-Warshall algorithm (https://en.wikipedia.org/wiki/Floyd-Warshall_algorithm), which processes the
+    // matrix in tiles of FW_BLOCK x FW_BLOCK lags that fit in cache. For each diagonal tile kb, first the tile itself is
+    // updated, then the other tiles in its row and column, and then all remaining tiles (which only depend on the
+    // former). Tiles within the last two phases are independent, so they are distributed over worker threads
+    int n = problem.njobs;
+    int nblocks = (n + FW_BLOCK - 1) / FW_BLOCK;
+    int workers = n >= FW_PARALLEL_MIN_JOBS ? nthreads : 1;
+    auto relaxTile = [&](int kb, int ib, int jb) {
+        int kEnd = min(n, (kb + 1) * FW_BLOCK), iEnd = min(n, (ib + 1) * FW_BLOCK), jEnd = min(n, (jb + 1) * FW_BLOCK);
+        for (int k = kb * FW_BLOCK; k < kEnd; k++) {
+            const int* lk = l[k].data();
+            for (int i = ib * FW_BLOCK; i < iEnd; i++) {
+                int* li = l[i].data();
+                int lik = li[k];
+                for (int j = jb * FW_BLOCK; j < jEnd; j++) {
+                    if (lik + lk[j] < li[j])
+                        li[j] = lik + lk[j];
+                }
             }
         }
+    };
+    for (int kb = 0; kb < nblocks; kb++) {
+        relaxTile(kb, kb, kb);
+        parallelFor(2 * nblocks, workers, [&](int b) {
+            int other = b / 2;
+            if (other == kb) return;
+            if (b % 2 == 0) relaxTile(kb, kb, other); // Tile in the same row
+            else relaxTile(kb, other, kb); // Tile in the same column
+        });
+        parallelFor(nblocks * nblocks, workers, [&](int b) {
+            int ib = b / nblocks, jb = b % nblocks;
+            if (ib != kb && jb != kb) relaxTile(kb, ib, jb);
+        });
+    }
+}
+
+void SmtEncoder::raiseLag(int i, int j, int lag) {
+    // Raising a lag cannot make any other path shorter, and all other lags already satisfy the triangle inequality,
+    // so rerunning Floyd-Warshall would only lower l[i][j] again to the shortest path through another activity
+    l[i][j] = lag;
+    for (int k = 0; k < problem.njobs; k++) {
+        if (l[i][k] + l[k][j] < l[i][j])
+            l[i][j] = l[i][k] + l[k][j];
     }
 }
 
@@ -70,43 +108,36 @@ bool SmtEncoder::preprocess() {
     // Run Floyd-Warshall;
     floydWarshall();
 
-    // Construct extended precedence graph
+    // Construct extended precedence graph, and the same as bitsets in both directions (successors and predecessors)
+    EnergyProfile profile(problem);
+    int nwords = profile.words();
+    vector<uint64_t> after((size_t)problem.njobs * nwords, 0), before((size_t)problem.njobs * nwords, 0);
     Estar.reserve(problem.njobs);
     for (int i = 0; i < problem.njobs; i++) {
         for (int j = 0; j < problem.njobs; j++) {
-            if (l[i][j] < INT32_MAX / 2)
+            if (l[i][j] < INT32_MAX / 2) {
                 Estar[i].push_back(j);
+                after[(size_t)i * nwords + j / 64] |= (uint64_t)1 << (j % 64);
+                before[(size_t)j * nwords + i / 64] |= (uint64_t)1 << (i % 64);
+            }
         }
     }
 
-    // Use energetic reasoning on precedences to improve accuracy of time lags
-
-    // Find maximum capacity over time for each resource
-    vector<int> maxCapacities(problem.nresources, 0);
-    for (int k = 0; k < problem.nresources; k++)
-        for (int t = 0; t < problem.horizon; t++)
-            if (problem.capacities[k][t] > maxCapacities[k]) maxCapacities[k] = problem.capacities[k][t];
-
-    // Update time lags
+    // Use energetic reasoning on precedences to improve accuracy of time lags.
+    // The activities in between i and j are those in Estar[i] that also precede j (raising lags does not change which
+    // pairs are connected), so their energy is that of an intersection of bitsets (excluding j itself)
+    vector<int> energies(problem.nresources);
     for (int i = 0; i < problem.njobs; i++) {
         for (int j : Estar[i]) {
             if (i == j) continue;
+            profile.intersectionEnergy(&after[(size_t)i * nwords], &before[(size_t)j * nwords], energies.data());
             int maxRlb = -1;
             for (int k = 0; k < problem.nresources; k++) {
-                int rlb = 0;
-                for (int a: Estar[i]) {
-                    if (a == j || l[a][j] == INT32_MAX / 2) continue;
-                    for (int t = 0; t < problem.durations[a]; t++) rlb += problem.requests[a][k][t];
-                }
-                rlb /= maxCapacities[k];
+                int rlb = (energies[k] - profile.energy(j, k)) / profile.maxCapacity(k);
                 // Difference compared to the paper by M. Bofill et al. (2020): use maxRlb instead of durations[i]+maxRlb, the latter was likely a mistake in the paper
                 if (rlb > maxRlb) maxRlb = rlb;
             }
-            if (maxRlb > l[i][j]) {
-                l[i][j] = maxRlb;
-                // Rerun Floyd-Warshall to propagate update to other time lags
-                floydWarshall();
-            }
+            if (maxRlb > l[i][j]) raiseLag(i, j, maxRlb); // Propagate the update to the other time lags
         }
     }
 
@@ -121,7 +152,7 @@ bool SmtEncoder::preprocess() {
 }
 
 void SmtEncoder::initialise() {
-    yices_init();
+    initYices();
 
     // Create the variables
 
@@ -155,25 +186,31 @@ void SmtEncoder::encode() {
 
     if (!preprocessFeasible) {
 //        std::cout << "Preprocessing found instance to be infeasible" << std::endl;
-        formula = yices_false();
+        yices_assert_formula(ctx, yices_false());
         return;
     }
 
-    // Add precedence constraints
+    // Generate the clauses for the resource constraints (shared with SatEncoder), the start variables y_(i,t) need
+    // to be known before any constraint can be asserted. The resource clauses may have been generated already (see
+    // PortfolioEncoder), then only the start variables are numbered here
+    ClauseBuffer clauses;
+    ClauseStats stats = generateClauses(clauses, false, resourceClauses == nullptr);
+    vector<term_t> vars = clauseTerms(clauses, y, {});
+    YicesClauseSink sink(ctx, vars);
 
-    vector<term_t> precedenceConstrs;
+    // Add precedence constraints
 
     // Initial dummy activity starts at 0
-    precedenceConstrs.push_back(yices_arith_eq0_atom(S[0]));
+    sink.add(yices_arith_eq0_atom(S[0]));
     measurements->enc_n_clause++;
 
     // Start variables must be within time windows
     for (int i = 1; i < problem.njobs; i++) {
-        precedenceConstrs.push_back(yices_arith_geq_atom(S[i], yices_int32(ES[i])));
+        sink.add(yices_arith_geq_atom(S[i], yices_int32(ES[i])));
         measurements->enc_n_clause++;
     }
     for (int i = 1; i < problem.njobs; i++) {
-        precedenceConstrs.push_back(yices_arith_leq_atom(S[i], yices_int32(LS[i])));
+        sink.add(yices_arith_leq_atom(S[i], yices_int32(LS[i])));
         measurements->enc_n_clause++;
     }
 
@@ -181,7 +218,7 @@ void SmtEncoder::encode() {
     for (int i = 0; i < problem.njobs; i++) {
         for (int j : Estar[i]) {
             if (i == j) continue;
-            precedenceConstrs.push_back(yices_arith_geq_atom(yices_sub(S[j], S[i]), yices_int32(l[i][j])));
+            sink.add(yices_arith_geq_atom(yices_sub(S[j], S[i]), yices_int32(l[i][j])));
             measurements->enc_n_clause++;
         }
     }
@@ -191,101 +228,30 @@ void SmtEncoder::encode() {
         for (int t = ES[i]; t <= LS[i]; t++) { // t in STW(i)
             // y_(i,t) <=> (S_i = t) is encoded into (y_(i,t) => (S_i = t)) ^ ((S_i = t) => y_(i,t)), which is in turn
             // encoded into (~y_(i,t) v (S_i = t)) ^ (~(S_i = t) v y_(i,t))
-            precedenceConstrs.push_back(yices_or2(yices_not(y[i][-ES[i] + t]), yices_arith_eq_atom(S[i], yices_int32(t))));
-            precedenceConstrs.push_back(yices_or2(yices_not(yices_arith_eq_atom(S[i], yices_int32(t))), y[i][-ES[i] + t]));
+            sink.add(yices_or2(yices_not(y[i][-ES[i] + t]), yices_arith_eq_atom(S[i], yices_int32(t))));
+            sink.add(yices_or2(yices_not(yices_arith_eq_atom(S[i], yices_int32(t))), y[i][-ES[i] + t]));
             measurements->enc_n_clause += 2;
         }
     }
 
     // Add resource constraints
-
-    vector<term_t> resourceConstrs;
-
-    // List of pseudo-boolean (PB) constraints
-    vector<PBConstr> pbConstrs;
-
-    // Determine PB constraints
-    int q_i;
-    for (int k = 0; k < problem.nresources; k++) {
-        for (int t = 0; t < UB; t++) {
-            pbConstrs.emplace_back(problem.capacities[k][t]);
-            for (int i = 0; i < problem.njobs; i++) {
-                if (t < ES[i] || t >= LC[i]) continue; // only consider i if t in RTW(i)
-                for (int e = 0; e < problem.durations[i]; e++) {
-                    if (t-e < ES[i] || t-e > LS[i]) continue; // only consider e if t-e in STW(i)
-                    q_i = problem.requests[i][k][e];
-                    if (q_i == 0) continue;
-                    pbConstrs.back().addTerm(q_i, {i, -ES[i] + t-e});
-                }
-            }
-            if (pbConstrs.back().nTerms() == 0) pbConstrs.pop_back();
-        }
-    }
-
-    // Encode each PB constraint
-    for (const PBConstr& C : pbConstrs) {
-        // Construct an ROBDD (Reduced Ordered BDD), following Algorithm 1 and Example 24: BDD-1 from the paper by I. Abío et al. (2012) (reference in README.md)
-        BDD falseNode(false);
-        BDD trueNode(true);
-        vector<LSet> L;
-        for (int i = 0; i <= C.nTerms(); i++) {
-            int constsSum = 0;
-            for (int j = i; j < C.nTerms(); j++) constsSum += C.constant(j);
-            L.push_back(LSet({constsSum,INT32_MAX/2}, &trueNode));
-            L.back().insert({INT32_MIN/2, -1}, &falseNode);
-        }
-        pair<pair<int,int>,BDD*> result = BDD::BDDConstruction(0, C, C.K, L);
-        for (LSet& s : L) s.deleteTree();
-        BDD* robdd = result.second;
-        vector<BDD*> nodes;
-        int auxRoot = robdd->flatten(nodes);
-
-        // Add SAT clauses based on the ROBDD, following Example 24: BDD-1 from the paper by I. Abío et al. (2012) (reference in README.md)
-        int auxTerminalF = -1;
-        int auxTerminalT = -1;
-        for (int i = 0; i < (int)nodes.size(); i++) {
-            if (nodes[i]->terminal()) {
-                if (nodes[i]->terminalValue()) auxTerminalT = i;
-                else auxTerminalF = i;
-            }
-        }
-        if (auxTerminalF == -1) continue; // Skip if the constraint cannot be falsified
-        int* measure_bools = &(measurements->enc_n_boolv);
-        for (BDD* node : nodes) {
-            if (node->terminal()) continue;
-            term_t x = y[node->selector.first][node->selector.second];
-            // Add two clauses
-            resourceConstrs.push_back(yices_or2(node->fBranch->getAuxYices(measure_bools), yices_not(
-                    node->getAuxYices(measure_bools))));
-            resourceConstrs.push_back(yices_or3(node->tBranch->getAuxYices(measure_bools), yices_not(x), yices_not(
-                    node->getAuxYices(measure_bools))));
-            measurements->enc_n_clause += 2;
-        }
-        // Add three unary clauses
-        resourceConstrs.push_back(nodes[auxRoot]->getAuxYices(measure_bools));
-        resourceConstrs.push_back(yices_not(nodes[auxTerminalF]->getAuxYices(measure_bools)));
-        resourceConstrs.push_back(nodes[auxTerminalT]->getAuxYices(measure_bools));
-        measurements->enc_n_clause += 3;
-
-        for (BDD* node : nodes) if (!node->terminal()) delete node;
-    }
-
-    term_t f_precedence = yices_and(precedenceConstrs.size(), &precedenceConstrs.front());
-    term_t f_resource = yices_and(resourceConstrs.size(), &resourceConstrs.front());
-    formula = yices_and2(f_precedence, f_resource);
+    clauses.emit(sink);
+    sink.flush();
+    measurements->enc_n_clause += clauses.size();
+    if (resourceClauses != nullptr) stats = assertResourceClauses(y);
+    for (int t = 0; t < PB_N_ENCODINGS; t++) measurements->enc_n_pb[t] += stats.nPB[t];
+    measurements->enc_bdd_peak = (long)stats.pbPeak;
+
+    // The terms that were only needed for building the constraints can be deleted now that they have been asserted
+    vars.insert(vars.end(), S.begin(), S.end());
+    collectGarbage(vars);
 }
 
 vector<int> SmtEncoder::solve() {
     vector<int> solution;
 
-    // Pass formula to Yices
+    // The formula was already asserted by encode()
     int32_t code;
-    code = yices_assert_formula(ctx, formula);
-    if (code < 0) {
-        std::cerr << "Assert failed: code = " << code << ", error = " << yices_error_code() << std::endl;
-        yices_print_error(stderr);
-    }
-
     switch (yices_check_context(ctx, NULL)) {
         case STATUS_SAT: {
             std::cout << "Satisfiable" << std::endl;
@@ -333,11 +299,6 @@ void SmtEncoder::optimise() {
     // This optimisation procedure was inspired by the paper by M. Bofill et al. (2020) (reference in README.md)
 
     int32_t code, v;
-    code = yices_assert_formula(ctx, formula);
-    if (code < 0) {
-        std::cerr << "Assert failed: code = " << code << ", error = " << yices_error_code() << std::endl;
-        yices_print_error(stderr);
-    }
     smt_status_t status = yices_check_context(ctx, NULL);
     model_t* model;
     if (status == STATUS_SAT) {
@@ -357,7 +318,7 @@ void SmtEncoder::optimise() {
             }
             yices_free_model(model);
         }
-        UB = measurements->schedule.back() - 1;
+        UB = nextUB(measurements->schedule.back());
     }
     else if (status == STATUS_INTERRUPTED) {
 //        std::cout << "Search was interrupted" << std::endl;
@@ -365,17 +326,17 @@ void SmtEncoder::optimise() {
     }
     else if (status == STATUS_UNSAT) {
         measurements->schedule.clear();
-        measurements->certified = true;
+        certify();
         return;
     }
     else {
         std::cerr << "Unknown status when checking satisfiability" << std::endl;
         return;
     }
-    while (status == STATUS_SAT && UB >= LB) {
+    while (status == STATUS_SAT && UB >= LB && !stopRequested()) {
 //        std::cout << "Current makespan: " << measurements->schedule.back() << std::endl; // line for debugging
-        formula = yices_and2(formula, yices_arith_leq_atom(S.back(), yices_int32(UB)));
-        code = yices_assert_formula(ctx, formula);
+        // Only the new bound is asserted, the context keeps everything that was asserted and learned before
+        code = yices_assert_formula(ctx, yices_arith_leq_atom(S.back(), yices_int32(UB)));
         if (code < 0) {
             std::cerr << "Assert failed: code = " << code << ", error = " << yices_error_code() << std::endl;
             yices_print_error(stderr);
@@ -398,7 +359,7 @@ void SmtEncoder::optimise() {
                 }
                 yices_free_model(model);
             }
-            UB = measurements->schedule.back() - 1;
+            UB = nextUB(measurements->schedule.back());
         }
         else if (status == STATUS_INTERRUPTED) {
 //            std::cout << "Search was interrupted" << std::endl;
@@ -410,5 +371,5 @@ void SmtEncoder::optimise() {
         }
     }
 
-    if (status == STATUS_UNSAT || UB < LB) measurements->certified = true;
+    if (status == STATUS_UNSAT || UB < LB) certify();
 }
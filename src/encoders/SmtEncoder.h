@@ -27,6 +27,9 @@ SOFTWARE.
 
 #include "YicesEncoder.h"
 
+#define FW_BLOCK 32 // Size of the tiles for the blocked Floyd-Warshall algorithm
+#define FW_PARALLEL_MIN_JOBS 256 // Minimum number of activities for running Floyd-Warshall on multiple threads
+
 using namespace std;
 
 namespace RcpsptExact {
@@ -36,16 +39,20 @@ namespace RcpsptExact {
  */
 class SmtEncoder : public YicesEncoder {
 public:
-    // Constructor
-    SmtEncoder(Problem& p, pair<int,int> bounds, Measurements* m);
+    /**
+     * Constructor, which already preprocesses the instance.
+     *
+     * @param nthreads number of worker threads for preprocessing and encoding (see Encoder::nthreads)
+     */
+    SmtEncoder(Problem& p, pair<int,int> bounds, Measurements* m, int nthreads = defaultThreadCount());
     // Destructor
     ~SmtEncoder() {
         yices_free_context(ctx);
-        yices_exit();
+        exitYices();
     }
 
     /**
-     * Encodes the problem instance into SMT and stores the result in the 'formula' field.
+     * Encodes the problem instance into SMT and asserts the result into the Yices context.
      */
     void encode() override;
 
@@ -72,8 +79,21 @@ private:
     vector<term_t> S; // Variable S_i: start time of activity i
     vector<vector<term_t>> y; // Variable y_(i,t): boolean representing whether activity i starts at time t in STW(i)
 
+    /**
+     * Calculates the shortest time lags between all pairs of activities (in l), using a blocked Floyd-Warshall algorithm.
+     */
     void floydWarshall();
 
+    /**
+     * Raises the time lag from activity i to activity j, and updates l so that it stays closed under the triangle
+     * inequality (same result as rerunning floydWarshall(), in O(njobs) instead of O(njobs^3)).
+     *
+     * @param i first activity
+     * @param j second activity
+     * @param lag new time lag, at least the current one
+     */
+    void raiseLag(int i, int j, int lag);
+
     bool preprocessFeasible;
 
     /**
@@ -21,10 +21,14 @@ SOFTWARE.
 **************************************************************************************************/
 
 #include "WcnfEncoder.h"
-#include "ads/BDD.h"
-#include "ads/PBConstr.h"
+#include "../utils/MaxSatProcess.h"
 
 #include <sstream>
+#include <fstream>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace RcpsptExact;
 
@@ -37,218 +41,81 @@ bool WcnfEncoder::preprocess() {
     return calcTimeWindows();
 }
 
-void WcnfEncoder::encodeAndWriteToFile(const string& filePath) {
-    ofstream outFile(filePath);
-    if (!preprocessFeasible) {
-        writeInfeasible(outFile);
-        outFile.close();
-        return;
-    }
-
-    int nextIndex = 0; // Index to be used by the next Boolean variable to be added
-
-    vector<vector<int>> y; // indices of Boolean start variables y_(i,t)
-    int ny = 0;
-    y.reserve(problem.njobs);
-    for (int i = 0; i < problem.njobs; i++) {
-        y.emplace_back();
-        for (int t = ES[i]; t <= LS[i]; t++) { // t in STW(i) (start time window of activity i)
-            y[i].push_back(nextIndex++);
-            ny++;
-        }
-    }
-    vector<vector<int>> x; // indices of Boolean process variables x_(i,t)
-    int nx = 0;
-    x.reserve(problem.njobs);
-    for (int i = 0; i < problem.njobs; i++) {
-        x.emplace_back();
-        for (int t = ES[i]; t <= LC[i]; t++) { // t in RTW(i) (run time window of activity i)
-            x[i].push_back(nextIndex++);
-            nx++;
-        }
+bool WcnfEncoder::encodeAndWriteToFile(const string& filePath, bool headerless, bool cnf) {
+    int fd = open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Cannot open output file " << filePath << ": " << strerror(errno) << std::endl;
+        return false;
     }
+    bool success = encodeAndWrite(fd, headerless, cnf);
+    close(fd);
+    return success;
+}
 
-    int top = INT32_MAX/2; // Weight to be used for hard clauses
+bool WcnfEncoder::encodeAndWrite(int fd, bool headerless, bool cnf) {
+    WcnfWriter out(fd, headerless, cnf);
+    if (preprocessFeasible) encode(out);
+    else writeInfeasible(out);
+    return out.finish(nbvar);
+}
 
+void WcnfEncoder::encode(WcnfWriter& out) {
     // The following mapping from indices to variables will be used for the output file:
     //  - indices [1,...,ny] are the start variables
     //  - indices [ny+1,...,ny+nx] are the process variables
     //  - from index ny+nx+1 onwards are auxiliary variables
+    int ny = 0, nx = 0;
+    for (int i = 0; i < problem.njobs; i++) {
+        ny += LS[i] - ES[i] + 1; // t in STW(i) (start time window of activity i)
+        nx += LC[i] - ES[i] + 1; // t in RTW(i) (run time window of activity i)
+    }
 
     // Write a file header in the form of comments, containing information for converting from
     // a SAT model to a solution for the original problem.
     // First write the number of start and process variables
-    outFile << "c " << ny << ' ' << nx << '\n';
-    outFile << 'c' << '\n';
+    out.comment({ny, nx});
+    out.comment({});
     // Write the earliest and latest feasible start time for each activity
     for (int i = 0; i < problem.njobs; i++)
-        outFile << "c " << i+1 << ' ' << ES[i] << ' ' << LS[i] << '\n';
-    outFile << 'c' << '\n';
-
-    // Add precedence constraints
-
-    vector<string> precedenceConstrs;
+        out.comment({i+1, ES[i], LS[i]});
+    // The statistics of the encoding are filled in once the clauses have been written (see statsComment)
+    out.deferredComment();
+    out.comment({});
 
-    // Consistency clauses
-    for (int i = 0; i < problem.njobs; i++) {
-        for (int s = ES[i]; s <= LS[i]; s++) { // s in STW(i)
-            for (int t = s; t < s + problem.durations[i]; t++) {
-                string clause = to_string(top)
-                        + " -" + to_string(1 + y[i][-ES[i] + s])
-                        + ' ' + to_string(1 + x[i][-ES[i] + t])
-                        + " 0";
-                precedenceConstrs.push_back(clause);
-            }
-        }
-    }
-
-    // Job 0 starts at 0
-    precedenceConstrs.push_back(to_string(top) + ' ' + to_string(1 + y[0][0]) + " 0");
-
-    // Precedence clauses
-    for (int i = 1; i < problem.njobs; i++) {
-        for (int j : problem.predecessors[i]) {
-            for (int s = ES[i]; s <= LS[i]; s++) { // s in STW(i)
-                string clause = to_string(top)
-                        + " -" + to_string(1 + y[i][-ES[i] + s]);
-                // Also check t <= LS[j], in addition to the definition by Horbach, because for RCPSP/t resource constraints can cause 'gaps' between activities (j,i)
-                // Another difference: t <= ES[i]-durations[j] was replaced by t <= s-durations[j], the former definition was likely a mistake in the paper
-                for (int t = ES[j]; t <= s-problem.durations[j] && t <= LS[j]; t++) {
-                    clause += ' ' + to_string(1 + y[j][-ES[j] + t]);
-                }
-                clause += " 0";
-                precedenceConstrs.push_back(clause);
-            }
-        }
-    }
+    // The totals for the "p wcnf" line are filled in by the writer once all clauses have been written
+    out.header();
 
-    // Start clauses
-    for (int i = 1; i < problem.njobs; i++) {
-        string clause = to_string(top);
-        for (int s = ES[i]; s <= LS[i]; s++) { // s in STW(i)
-            clause += ' ' + to_string(1 + y[i][-ES[i] + s]);
-        }
-        clause += " 0";
-        precedenceConstrs.push_back(clause);
-    }
-
-    // Add redundant clauses that should improve runtime
-    for (int i = 0; i < problem.njobs; i++) {
-        for (int c = EC[i]; c < LC[i]; c++) {
-            string clause = to_string(top)
-                    + " -" + to_string(1 + x[i][-ES[i] + c])
-                    + ' ' + to_string(1 + x[i][-ES[i] + c+1])
-                    + ' ' + to_string(1 + y[i][-ES[i] + c-problem.durations[i]+1])
-                    + " 0";
-            precedenceConstrs.push_back(clause);
-        }
-    }
-
-    // Add resource constraints
-
-    vector<string> resourceConstrs;
-
-    // List of pseudo-boolean (PB) constraints
-    vector<PBConstr> pbConstrs;
-
-    // Determine PB constraints
-    int q_i;
-    for (int k = 0; k < problem.nresources; k++) {
-        for (int t = 0; t < UB; t++) {
-            pbConstrs.emplace_back(problem.capacities[k][t]);
-            for (int i = 0; i < problem.njobs; i++) {
-                if (t < ES[i] || t >= LC[i]) continue; // only consider i if t in RTW(i)
-                for (int e = 0; e < problem.durations[i]; e++) {
-                    if (t-e < ES[i] || t-e > LS[i]) continue; // only consider e if t-e in STW(i)
-                    q_i = problem.requests[i][k][e];
-                    if (q_i == 0) continue;
-                    pbConstrs.back().addTerm(q_i, {i, -ES[i] + t-e});
-                }
-            }
-            if (pbConstrs.back().nTerms() == 0) pbConstrs.pop_back();
-        }
-    }
-
-    // Encode each PB constraint
-    for (const PBConstr& C : pbConstrs) {
-        // Construct an ROBDD (Reduced Ordered BDD), following Algorithm 1 and Example 24: BDD-1 from the paper by I. Abío et al. (2012) (reference in README.md)
-        BDD falseNode(false);
-        BDD trueNode(true);
-        vector<LSet> L;
-        for (int i = 0; i <= C.nTerms(); i++) {
-            int constsSum = 0;
-            for (int j = i; j < C.nTerms(); j++) constsSum += C.constant(j);
-            L.push_back(LSet({constsSum,INT32_MAX/2}, &trueNode));
-            L.back().insert({INT32_MIN/2, -1}, &falseNode);
-        }
-        pair<pair<int,int>,BDD*> result = BDD::BDDConstruction(0, C, C.K, L);
-        for (LSet& s : L) s.deleteTree();
-        BDD* robdd = result.second;
-        vector<BDD*> nodes;
-        int auxRoot = robdd->flatten(nodes);
-
-        // Add SAT clauses based on the ROBDD, following Example 24: BDD-1 from the paper by I. Abío et al. (2012) (reference in README.md)
-        int auxTerminalF = -1;
-        int auxTerminalT = -1;
-        for (int i = 0; i < (int)nodes.size(); i++) {
-            if (nodes[i]->terminal()) {
-                if (nodes[i]->terminalValue()) auxTerminalT = i;
-                else auxTerminalF = i;
-            }
-        }
-        if (auxTerminalF == -1) continue; // Skip if the constraint cannot be falsified
-        for (BDD* node : nodes) {
-            if (node->terminal()) continue;
-            term_t selector = y[node->selector.first][node->selector.second];
-            // Add two clauses
-            string clause1 = to_string(top)
-                    + ' ' + to_string(1 + node->fBranch->getAuxWcnf(&nextIndex))
-                    + " -" + to_string(1 + node->getAuxWcnf(&nextIndex))
-                    + " 0";
-            resourceConstrs.push_back(clause1);
-            string clause2 = to_string(top)
-                    + ' ' + to_string(1 + node->tBranch->getAuxWcnf(&nextIndex))
-                    + " -" + to_string(1 + selector)
-                    + " -" + to_string(1 + node->getAuxWcnf(&nextIndex))
-                    + " 0";
-            resourceConstrs.push_back(clause2);
-        }
-        // Add three unary clauses
-        resourceConstrs.push_back(to_string(top) + ' ' + to_string(1 + nodes[auxRoot]->getAuxWcnf(&nextIndex)) + " 0");
-        resourceConstrs.push_back(to_string(top) + " -" + to_string(1 + nodes[auxTerminalF]->getAuxWcnf(&nextIndex)) + " 0");
-        resourceConstrs.push_back(to_string(top) + ' ' + to_string(1 + nodes[auxTerminalT]->getAuxWcnf(&nextIndex)) + " 0");
-
-        for (BDD* node : nodes) if (!node->terminal()) delete node;
-    }
+    // The hard clauses are the same as the clauses of the SAT encoding used by SatEncoder. They are streamed to the
+    // file while they are generated, so they are not deduplicated here.
+    ClauseBuffer clauses(&out);
+    stats = generateClauses(clauses, true);
+    out.setDeferredComment(statsComment(stats));
 
     // Add clauses to define the objective of minimising the makespan
 
-    vector<string> optClauses;
-
     // Activity n+1 may only be scheduled once
+    int last = problem.njobs - 1;
     for (int t = ES.back(); t <= LS.back(); t++) { // t in STW(n+1)
         for (int u = ES.back(); u <= LS.back(); u++) { // u in STW(n+1)
             if (t == u) continue;
-            optClauses.push_back(to_string(top) + " -" + to_string(1 + y.back()[-ES.back() + t]) + " -" + to_string(1 + y.back()[-ES.back() + u]) + " 0");
+            out.beginHard();
+            out.lit(-startVar(last, t));
+            out.lit(-startVar(last, u));
+            out.endClause();
         }
     }
 
-    int currWeight = 1;
-    // Soft clauses: weight increases for not starting activity n+1 earlier
-    for (int t = LS.back(); t >= ES.back(); t--) { // t in STW(n+1)
-        optClauses.push_back(to_string(currWeight++) + ' ' + to_string(1 + y.back()[-ES.back() + t]) + " 0");
+    if (!out.cnf()) {
+        int currWeight = 1;
+        // Soft clauses: weight increases for not starting activity n+1 earlier
+        for (int t = LS.back(); t >= ES.back(); t--) { // t in STW(n+1)
+            out.beginSoft(currWeight++);
+            out.lit(startVar(last, t));
+            out.endClause();
+        }
     }
 
-    // Write the encoded problem to the file
-
-    int nbvar = nextIndex;
-    int nbclauses = (int)precedenceConstrs.size() + (int)resourceConstrs.size() + (int)optClauses.size();
-    outFile << "p wcnf " << nbvar << ' ' << nbclauses << ' ' << top << '\n';
-    for (const string& ln : precedenceConstrs) outFile << ln << '\n';
-    for (const string& ln : resourceConstrs) outFile << ln << '\n';
-    for (const string& ln : optClauses) outFile << ln << '\n';
-
-    outFile.close();
+    nbvar = clauses.nVars();
 }
 
 string WcnfEncoder::getAndCheckSolution(const string &model) {
@@ -261,11 +128,80 @@ string WcnfEncoder::getAndCheckSolution(const string &model) {
         lits.push_back(substr[0] != '-');
     }
 
+    return getAndCheckSolution(lits);
+}
+
+string WcnfEncoder::getAndCheckSolution(const vector<bool>& lits) {
+    if (!preprocessFeasible) return "-1, 1, ";
+
+    return checkSolution(problem, ES, LS, lits);
+}
+
+string WcnfEncoder::decodeWithHeader(const Problem& problem, const string& wcnfPath, const string& modelPath) {
+    // Read the earliest and latest start times from the comment header written by encode()
+    ifstream wcnfFile(wcnfPath);
+    if (!wcnfFile) return "-1, 0, " + statsColumns(nullptr);
+    vector<int> ES(problem.njobs), LS(problem.njobs);
+    string line;
+    getline(wcnfFile, line);
+    ClauseStats stats; // No resource constraints are encoded for a trivially infeasible instance
+    if (line.empty() || line[0] != 'c') return "-1, 1, " + statsColumns(&stats); // Trivially infeasible instance (see writeInfeasible)
+    getline(wcnfFile, line); // Empty comment line
+    for (int i = 0; i < problem.njobs; i++) {
+        char c;
+        int job;
+        if (!(wcnfFile >> c >> job >> ES[i] >> LS[i]) || c != 'c' || job != i + 1) {
+            std::cerr << "Invalid WCNF header in " << wcnfPath << std::endl;
+            return "-1, 0, " + statsColumns(nullptr);
+        }
+    }
+    // The statistics of the encoding follow, if they were written (not by older versions, or to a pipe)
+    getline(wcnfFile, line); // Rest of the line of the last activity
+    getline(wcnfFile, line);
+    bool statsRead = parseStatsComment(line, stats);
+    wcnfFile.close();
+
+    ifstream modelFile(modelPath);
+    getline(modelFile, line);
+    modelFile.close();
+    const char* p = line.data();
+    const char* end = p + line.size();
+    if (line.size() >= 2 && line[0] == 'v' && line[1] == ' ') p += 2;
+    vector<bool> lits;
+    MaxSatProcess::parseModelLine(p, end, lits);
+
+    return checkSolution(problem, ES, LS, lits) + statsColumns(statsRead ? &stats : nullptr);
+}
+
+string WcnfEncoder::statsColumns(const ClauseStats* stats) {
+    string columns;
+    for (int t = 0; t < PB_N_ENCODINGS; t++) columns += ", " + to_string(stats != nullptr ? stats->nPB[t] : -1);
+    columns += ", " + to_string(stats != nullptr ? (long)stats->pbPeak : -1);
+    return columns;
+}
+
+string WcnfEncoder::statsComment(const ClauseStats& stats) {
+    string line = "c pb";
+    for (int t = 0; t < PB_N_ENCODINGS; t++) line += ' ' + to_string(stats.nPB[t]);
+    line += ' ' + to_string(stats.pbPeak);
+    return line;
+}
+
+bool WcnfEncoder::parseStatsComment(const string& line, ClauseStats& stats) {
+    istringstream iss(line);
+    string c, pb;
+    if (!(iss >> c >> pb) || c != "c" || pb != "pb") return false;
+    for (int t = 0; t < PB_N_ENCODINGS; t++) if (!(iss >> stats.nPB[t])) return false;
+    return (bool)(iss >> stats.pbPeak);
+}
+
+string WcnfEncoder::checkSolution(const Problem& problem, const vector<int>& ES, const vector<int>& LS, const vector<bool>& lits) {
     vector<int> starts(problem.njobs, -1);
     int curr = 0;
     for (int i = 0; i < problem.njobs; i++) {
         for (int t = ES[i]; t <= LS[i]; t++) { // t in STW(i) (start time window of activity i)
-            if (lits[curr++] && starts[i] == -1) starts[i] = t;
+            if (curr < (int)lits.size() && lits[curr] && starts[i] == -1) starts[i] = t;
+            curr++;
         }
     }
 
@@ -277,11 +213,15 @@ string WcnfEncoder::getAndCheckSolution(const string &model) {
     return output;
 }
 
-void WcnfEncoder::writeInfeasible(ofstream& outFile) {
-    int top = INT32_MAX/2;
-    outFile << "p wcnf 1 2 " << to_string(top) << std::endl;
-    outFile << to_string(top) << " 1 0" << std::endl;
-    outFile << to_string(top) << " -1 0" << std::endl;
+void WcnfEncoder::writeInfeasible(WcnfWriter& out) {
+    out.header();
+    out.beginHard();
+    out.lit(1);
+    out.endClause();
+    out.beginHard();
+    out.lit(-1);
+    out.endClause();
+    nbvar = 1;
 }
 
 #include "WcnfEncoder.h"
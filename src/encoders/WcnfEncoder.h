@@ -24,9 +24,9 @@ SOFTWARE.
 #define RCPSPT_EXACT_WCNFENCODER_H
 
 #include "Encoder.h"
+#include "../utils/WcnfWriter.h"
 
 #include <string>
-#include <fstream>
 
 namespace RcpsptExact {
 
@@ -42,10 +42,28 @@ public:
      * Encodes the problem into MAX-SAT, WCNF format, and writes this encoding to a file.
      * The encoding is the same as the SAT encoding used by SatEncoder, except that soft clauses
      * are added for specifying the objective function of minimising the makespan.
+     * Clauses are streamed to the file while they are generated, so unlike in the Yices backends, duplicate clauses are
+     * not removed.
      *
      * @param filePath name of the file to write to
+     * @param headerless whether to use the headerless WCNF format (MaxSAT Evaluation 2022) instead of the classic one
+     * @param cnf whether to write only the hard clauses, as plain CNF in DIMACS format (satisfiable iff there is a
+     * schedule with a makespan of at most the upper bound)
+     * @return false if the file could not be written, true otherwise
      */
-    void encodeAndWriteToFile(const string& filePath);
+    bool encodeAndWriteToFile(const string& filePath, bool headerless = false, bool cnf = false);
+
+    /**
+     * Encodes the problem into MAX-SAT, WCNF format, and streams the encoding to the given file descriptor
+     * (for example a pipe to a MaxSAT solver).
+     *
+     * @param fd file descriptor to write to (is not closed)
+     * @param headerless whether to use the headerless WCNF format (MaxSAT Evaluation 2022) instead of the classic one,
+     * required if fd is not seekable
+     * @param cnf whether to write only the hard clauses, as plain CNF in DIMACS format (requires fd to be seekable)
+     * @return false if the encoding could not be written, true otherwise
+     */
+    bool encodeAndWrite(int fd, bool headerless, bool cnf = false);
 
     /**
      * Given a model generated by some MaxSAT solver, gets the solution to the original problem.
@@ -57,9 +75,49 @@ public:
      */
     string getAndCheckSolution(const string& model);
 
+    /**
+     * Given a model generated by some MaxSAT solver, gets the solution to the original problem.
+     * Returns a string in the same format as getAndCheckSolution(const string&).
+     *
+     * @param lits for each variable (index 0 is variable 1) whether it is true in the model
+     * @return the output string
+     */
+    string getAndCheckSolution(const vector<bool>& lits);
+
+    /**
+     * Given a model generated by some MaxSAT solver, gets the solution to the original problem.
+     * Unlike getAndCheckSolution, this does not require preprocessing: the start time windows are read from the
+     * comment header of the WCNF file that was solved.
+     * Returns a string in the same format as getAndCheckSolution(const string&), followed by the statistics of the
+     * encoding from the header (see statsColumns, unknown for files written by older versions or to a pipe).
+     *
+     * @param problem the original problem
+     * @param wcnfPath path of the WCNF file written by encodeAndWriteToFile
+     * @param modelPath path of the model file (first line: the model)
+     * @return the output string
+     */
+    static string decodeWithHeader(const Problem& problem, const string& wcnfPath, const string& modelPath);
+
+    /**
+     * Formats statistics of the encoding as extra output columns:
+     * , [number of resource constraints encoded with each PBEncodingType], [peak memory in bytes used for the decision
+     * diagram of a single PB constraint]
+     *
+     * @param stats the statistics, nullptr if they are unknown (then -1 is output for each)
+     */
+    static string statsColumns(const ClauseStats* stats);
+
+    /**
+     * @return statistics of the clauses written by the last call to encodeAndWrite(ToFile)
+     */
+    const ClauseStats& clauseStats() const { return stats; }
+
 private:
     bool preprocessFeasible;
 
+    int nbvar = 0; // Total number of Boolean variables in the written encoding
+    ClauseStats stats; // Statistics of the written clauses
+
     /**
      * Perform preprocessing to reduce the amount of variables in the final encoding.
      *
@@ -68,11 +126,42 @@ private:
     bool preprocess();
 
     /**
-     * Writes a trivially infeasible instance to the output file.
+     * Encodes the problem and writes the clauses to the given writer.
+     *
+     * @param out the writer to write to
+     */
+    void encode(WcnfWriter& out);
+
+    /**
+     * Writes a trivially infeasible instance to the given writer.
+     *
+     * @param out the writer to write to
+     */
+    void writeInfeasible(WcnfWriter& out);
+
+    /**
+     * Decodes the start times from a model, and checks whether they form a valid solution.
+     *
+     * @param problem the original problem
+     * @param ES earliest start time for each activity
+     * @param LS latest start time for each activity
+     * @param lits for each variable (index 0 is variable 1) whether it is true in the model
+     * @return the output string (see getAndCheckSolution)
+     */
+    static string checkSolution(const Problem& problem, const vector<int>& ES, const vector<int>& LS, const vector<bool>& lits);
+
+    /**
+     * Formats statistics of the encoding as the comment line "c pb [number of resource constraints encoded with each
+     * PBEncodingType] [peak memory of a decision diagram]", which is written in the header (after the time windows).
+     */
+    static string statsComment(const ClauseStats& stats);
+
+    /**
+     * Parses a comment line written by statsComment.
      *
-     * @param outFile the file to write to
+     * @return false if the line is not such a comment
      */
-    static void writeInfeasible(ofstream& outFile);
+    static bool parseStatsComment(const string& line, ClauseStats& stats);
 };
 }
 
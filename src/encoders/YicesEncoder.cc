@@ -20,7 +20,9 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 **************************************************************************************************/
 
+#include <algorithm>
 #include <iostream>
+#include <mutex>
 #include <queue>
 
 #include "YicesEncoder.h"
@@ -34,18 +36,93 @@ YicesEncoder::YicesEncoder(Problem &p, pair<int, int> bounds, Measurements* m)
 
 YicesEncoder::~YicesEncoder() = default;
 
-void YicesEncoder::printResults() const {
-    std::cout << measurements->file << ", ";
-    std::cout << measurements->enc_n_boolv << ", ";
-    std::cout << measurements->enc_n_intv << ", ";
-    std::cout << measurements->enc_n_clause << ", ";
-    std::cout << measurements->t_enc << ", ";
-    std::cout << measurements->t_search << ", ";
-    std::cout << (long)(clock() * 1000 / CLOCKS_PER_SEC) << ", ";
-    if (measurements->schedule.empty()) std::cout << -1 << ", ";
-    else std::cout << measurements->schedule.back() << ", ";
-    std::cout << ValidityChecker::checkValid(problem, measurements->schedule) << ", ";
-    std::cout << measurements->certified << ", ";
-    for (int start : measurements->schedule) std::cout << start << ".";
-    std::cout << std::endl;
+static mutex yicesMutex;
+static int yicesUsers = 0; // Number of encoders currently using Yices
+
+void YicesEncoder::initYices() {
+    lock_guard<mutex> lock(yicesMutex);
+    if (yicesUsers++ == 0) yices_init();
+}
+
+void YicesEncoder::exitYices() {
+    lock_guard<mutex> lock(yicesMutex);
+    if (--yicesUsers == 0) yices_exit();
+}
+
+bool YicesEncoder::searching() const {
+    return yices_context_status(ctx) == STATUS_SEARCHING;
+}
+
+void YicesEncoder::interrupt() {
+    yices_stop_search(ctx);
+}
+
+int YicesEncoder::nextUB(int makespan) {
+    if (shared == nullptr) return makespan - 1;
+    int best = shared->makespan;
+    while (makespan < best && !shared->makespan.compare_exchange_weak(best, makespan));
+    return min(makespan, best) - 1;
+}
+
+void YicesClauseSink::flush() {
+    if (chunk.empty()) return;
+    int32_t code = yices_assert_formulas(ctx, chunk.size(), chunk.data());
+    if (code < 0) {
+        std::cerr << "Assert failed: code = " << code << ", error = " << yices_error_code() << std::endl;
+        yices_print_error(stderr);
+    }
+    chunk.clear();
+}
+
+vector<term_t> YicesEncoder::clauseTerms(const ClauseBuffer& clauses, const vector<vector<term_t>>& y, const vector<vector<term_t>>& x) {
+    vector<term_t> vars;
+    vars.reserve(clauses.nVars());
+    for (const vector<term_t>& terms : y) vars.insert(vars.end(), terms.begin(), terms.end());
+    for (const vector<term_t>& terms : x) vars.insert(vars.end(), terms.begin(), terms.end());
+    measurements->enc_n_boolv += clauses.nVars() - (int)vars.size(); // Keep track of the number of boolean variables that is being created
+    while ((int)vars.size() < clauses.nVars()) vars.push_back(yices_new_uninterpreted_term(yices_bool_type()));
+    return vars;
+}
+
+ClauseStats YicesEncoder::assertResourceClauses(const vector<vector<term_t>>& y) {
+    vector<term_t> vars = clauseTerms(resourceClauses->clauses, y, {});
+    YicesClauseSink sink(ctx, vars);
+    resourceClauses->clauses.emit(sink);
+    sink.flush();
+    measurements->enc_n_clause += resourceClauses->clauses.size();
+    ClauseStats stats = resourceClauses->stats;
+    resourceClauses.reset();
+    return stats;
+}
+
+void YicesEncoder::collectGarbage(const vector<term_t>& roots) {
+    if (shared != nullptr) return;
+    // The lock keeps other encoders from starting to use Yices while collecting
+    lock_guard<mutex> lock(yicesMutex);
+    if (yicesUsers > 1) return;
+    yices_garbage_collect(roots.data(), roots.size(), NULL, 0, false);
+}
+
+void YicesEncoder::certify() {
+    measurements->certified = true;
+    if (shared != nullptr) shared->certified = true;
+}
+
+void YicesEncoder::printResults(ostream& out) const {
+    out << measurements->file << ", ";
+    out << measurements->enc_n_boolv << ", ";
+    out << measurements->enc_n_intv << ", ";
+    out << measurements->enc_n_clause << ", ";
+    out << measurements->t_enc << ", ";
+    out << measurements->t_search << ", ";
+    out << measurements->now() - measurements->t_start << ", ";
+    if (measurements->schedule.empty()) out << -1 << ", ";
+    else out << measurements->schedule.back() << ", ";
+    out << ValidityChecker::checkValid(problem, measurements->schedule) << ", ";
+    out << measurements->certified << ", ";
+    for (int start : measurements->schedule) out << start << ".";
+    out << ", " << measurements->t_preprocess;
+    for (int t = 0; t < PB_N_ENCODINGS; t++) out << ", " << measurements->enc_n_pb[t];
+    out << ", " << measurements->enc_bdd_peak;
+    out << std::endl;
 }
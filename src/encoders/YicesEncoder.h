@@ -23,12 +23,35 @@ SOFTWARE.
 #ifndef RCPSPT_EXACT_YICESENCODER_H
 #define RCPSPT_EXACT_YICESENCODER_H
 
+#include <atomic>
+#include <chrono>
 #include <ctime>
+#include <iostream>
 
 #include "Encoder.h"
 #include "yices.h"
 
+#define YICES_ASSERT_CHUNK 4096 // Number of terms that YicesClauseSink asserts at once
+
 namespace RcpsptExact {
+/**
+ * Gets the CPU time in ms that has been used by the whole process (like clock()), or only by the calling thread.
+ *
+ * @param thread whether to get the CPU time of the calling thread instead of the process
+ */
+inline long cpuTimeMs(bool thread = false) {
+    timespec ts;
+    clock_gettime(thread ? CLOCK_THREAD_CPUTIME_ID : CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * Gets the wall-clock time in ms (from a monotonic clock, with an arbitrary starting point).
+ */
+inline long wallTimeMs() {
+    return (long)chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 /**
  * Struct containing all data points that are measured for the SMT and SAT approaches using Yices.
  */
@@ -37,10 +60,67 @@ struct Measurements {
     int enc_n_boolv = 0; // Number of Boolean variables in encoding
     int enc_n_intv = 0; // Number of integer variables in encoding
     int enc_n_clause = 0; // Number of clauses in encoding
+    int enc_n_pb[PB_N_ENCODINGS] = {}; // Number of resource constraints encoded with each PBEncodingType
+    long enc_bdd_peak = 0; // Peak memory in bytes used for the decision diagram of a single PB constraint
     long t_enc = 0; // Time in ms spent on encoding
+    long t_preprocess = 0; // Time in ms spent on preprocessing (included in t_enc)
     long t_search = 0; // Time in ms spent on searching (optimising)
+    long t_start = 0; // Time (see now()) at which work on this instance started
+    bool wallClock = false; // Whether times are measured in wall-clock time instead of CPU time (for encoders using several threads)
+    bool threadClock = false; // Whether CPU time is measured for the calling thread only instead of the process (for instances solved concurrently)
     bool certified = false; // Whether the current best solution has been proven optimal (or infeasible)
     vector<int> schedule = {}; // Current best solution (after optimisation: empty vector if problem is infeasible)
+
+    /**
+     * @return the current time in ms, measured as wall-clock time or as CPU time (see wallClock and threadClock)
+     */
+    long now() const { return wallClock ? wallTimeMs() : cpuTimeMs(threadClock); }
+};
+
+/**
+ * Makespan bound that is shared by encoders optimising the same instance concurrently (see PortfolioEncoder).
+ */
+struct SharedBound {
+    atomic<int> makespan{INT32_MAX}; // Best makespan found so far by any of the encoders
+    atomic<bool> certified{false}; // Whether one of the encoders has proven the best makespan optimal (or the instance infeasible)
+};
+
+/**
+ * ClauseSink that asserts clauses (disjunctions of Boolean terms) into a Yices context. Terms are asserted in chunks
+ * with yices_assert_formulas, instead of being collected into one large conjunction.
+ */
+class YicesClauseSink : public ClauseSink {
+public:
+    /**
+     * @param ctx context to assert the clauses into
+     * @param vars Boolean term for each variable of the clauses (index 0 is variable 1)
+     */
+    YicesClauseSink(context_t* ctx, const vector<term_t>& vars) : ctx(ctx), vars(vars) {}
+
+    void clause(const int* lits, int n) override {
+        terms.clear();
+        for (int i = 0; i < n; i++) terms.push_back(lits[i] > 0 ? vars[lits[i] - 1] : yices_not(vars[-lits[i] - 1]));
+        add(yices_or(n, terms.data()));
+    }
+
+    /**
+     * Asserts a term (not necessarily a clause), once the current chunk is full.
+     */
+    void add(term_t t) {
+        chunk.push_back(t);
+        if (chunk.size() >= YICES_ASSERT_CHUNK) flush();
+    }
+
+    /**
+     * Asserts the remaining terms, must be called after the last clause.
+     */
+    void flush();
+
+private:
+    context_t* ctx;
+    const vector<term_t>& vars;
+    vector<term_t> terms; // Terms of the literals of the current clause
+    vector<term_t> chunk; // Terms that have not been asserted yet
 };
 
 /**
@@ -56,20 +136,92 @@ public:
 
     /**
      * Outputs measurement results to the console, in the following format:
-     * file, enc_n_boolv, enc_n_intv, enc_n_clause, t_enc, t_solve, t_total, makespan, valid, certified, schedule
+     * file, enc_n_boolv, enc_n_intv, enc_n_clause, t_enc, t_solve, t_total, makespan, valid, certified, schedule, t_preprocess,
+     * enc_n_pb (one column per PBEncodingType, in the order of the enum), enc_bdd_peak
+     * (the columns from t_preprocess onwards were added last, so that the earlier columns are the same as in older versions)
      *
      * An example would look like this:
-     * path/to/file.smt, 12, 5, 60, 65, 128, 300, 20, 1, 1, 0.0.3.4.7.
+     * path/to/file.smt, 12, 5, 60, 65, 128, 300, 20, 1, 1, 0.0.3.4.7., 4, 3, 1, 0, 0, 2, 0, 24896
+     *
+     * @param out the stream to write to
      */
-    void printResults() const;
+    void printResults(ostream& out = std::cout) const;
+
+    /**
+     * @return true if Yices is currently searching for a solution
+     */
+    virtual bool searching() const;
+
+    /**
+     * Interrupts the current search of Yices (if any), see optimise().
+     */
+    virtual void interrupt();
 
     context_t* ctx; // Yices context
     Measurements* measurements;
+    SharedBound* shared = nullptr; // Bound shared with other encoders optimising the same instance (nullptr if none)
+    shared_ptr<const ResourceClauses> resourceClauses; // Resource clauses generated for several encoders, used (and released) by the next encode() instead of generating them (nullptr if none)
 
 protected:
     YicesEncoder(Problem &p, pair<int, int> bounds, Measurements* m);
 
-    term_t formula; // Formula that will be used when calling solve()
+    /**
+     * Initialises Yices when it is not yet in use by another encoder.
+     * Yices has global state (shared by all contexts), so it may only be exited once no encoder uses it anymore.
+     */
+    static void initYices();
+
+    /**
+     * Exits Yices when this was the last encoder using it.
+     */
+    static void exitYices();
+
+    /**
+     * Determines the next upper bound to try after a solution with the given makespan has been found.
+     * The makespan is published to the shared bound (if any), and a better makespan found by another encoder is used.
+     *
+     * @param makespan makespan of the solution found by this encoder
+     * @return the new upper bound on the makespan
+     */
+    int nextUB(int makespan);
+
+    /**
+     * Gets a Boolean term for each variable of clauses generated by generateClauses. The start and process variables
+     * are the given terms, for the auxiliary variables new terms are created (and counted in the measurements).
+     *
+     * @param y term for each variable y_(i,t), t in STW(i)
+     * @param x term for each variable x_(i,t), t in RTW(i) (empty if the clauses have no process variables)
+     * @return the term for each variable (index 0 is variable 1)
+     */
+    vector<term_t> clauseTerms(const ClauseBuffer& clauses, const vector<vector<term_t>>& y, const vector<vector<term_t>>& x);
+
+    /**
+     * Asserts the shared resource clauses (see resourceClauses, which must be set) and releases them.
+     *
+     * @param y term for each variable y_(i,t), t in STW(i)
+     * @return statistics of the clauses
+     */
+    ClauseStats assertResourceClauses(const vector<vector<term_t>>& y);
+
+    /**
+     * Deletes the Yices terms that are no longer used (terms that are used by a context are always kept). This is
+     * skipped when another encoder may be using Yices concurrently (see PortfolioEncoder, or the instances solved in
+     * parallel in batch mode): Yices has a single term table, and the terms that are held by the other encoder would
+     * not be protected.
+     *
+     * @param roots terms that will still be used by this encoder
+     */
+    void collectGarbage(const vector<term_t>& roots);
+
+    /**
+     * @return true if another encoder has already certified its result, so that optimising further is pointless
+     */
+    bool stopRequested() const { return shared != nullptr && shared->certified; }
+
+    /**
+     * Records that this encoder has certified the (shared) best makespan optimal, or the instance infeasible.
+     */
+    void certify();
 };
 }
 
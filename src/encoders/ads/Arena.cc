@@ -0,0 +1,57 @@
+/****************************************************************************************[Arena.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#include <algorithm>
+
+#include "Arena.h"
+
+using namespace RcpsptExact;
+
+Arena::Arena(size_t blockSize)
+        : blockSize(blockSize), current(0), offset(0), usedBefore(0), peak(0) {}
+
+void Arena::reset() {
+    current = 0;
+    offset = 0;
+    usedBefore = 0;
+}
+
+void* Arena::allocate(size_t size, size_t align) {
+    while (true) {
+        if (current < blocks.size()) {
+            size_t start = (offset + align - 1) / align * align;
+            if (start + size <= blockSizes[current]) {
+                offset = start + size;
+                peak = max(peak, used());
+                return blocks[current].get() + start;
+            }
+            // Continue in the next block (a block that was kept from before, or a new one)
+            usedBefore += offset;
+            current++;
+            offset = 0;
+            if (current < blocks.size()) continue;
+        }
+        size_t newSize = max(blockSize, size + align);
+        blocks.emplace_back(new char[newSize]);
+        blockSizes.push_back(newSize);
+    }
+}
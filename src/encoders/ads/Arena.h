@@ -0,0 +1,99 @@
+/*****************************************************************************************[Arena.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#ifndef RCPSPT_EXACT_ARENA_H
+#define RCPSPT_EXACT_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace RcpsptExact {
+
+/**
+ * Bump allocator for the many small, short-lived nodes that are created while encoding a PB constraint (BDD and MDD).
+ * Memory is taken from blocks that are kept for reuse, so after reset() (which takes O(1)) the next constraint does
+ * not allocate from the heap again until it needs more memory than any constraint before it.
+ *
+ * Objects are never destructed, so only trivially destructible types can be allocated.
+ */
+class Arena {
+public:
+    /**
+     * @param blockSize size in bytes of each block of memory
+     */
+    explicit Arena(size_t blockSize = 1 << 16);
+
+    /**
+     * Constructs an object in the arena, which stays valid until the next reset().
+     */
+    template<typename T, typename... Args>
+    T* make(Args&&... args) {
+        static_assert(is_trivially_destructible<T>::value, "Objects in an Arena are never destructed");
+        return new (allocate(sizeof(T), alignof(T))) T(forward<Args>(args)...);
+    }
+
+    /**
+     * Constructs an array of n (value-initialised) objects in the arena, which stays valid until the next reset().
+     */
+    template<typename T>
+    T* makeArray(size_t n) {
+        static_assert(is_trivially_destructible<T>::value, "Objects in an Arena are never destructed");
+        T* array = static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+        for (size_t i = 0; i < n; i++) new (array + i) T();
+        return array;
+    }
+
+    /**
+     * Releases all objects at once, keeping the blocks of memory for reuse.
+     */
+    void reset();
+
+    /**
+     * @return the number of bytes that are currently in use
+     */
+    size_t used() const { return usedBefore + offset; }
+
+    /**
+     * @return the maximum number of bytes that have been in use at the same time (high-water mark)
+     */
+    size_t highWater() const { return peak; }
+
+private:
+    size_t blockSize;
+    vector<unique_ptr<char[]>> blocks;
+    vector<size_t> blockSizes; // Blocks may be larger than blockSize, for objects that do not fit in one
+    size_t current; // Index of the block that is being filled
+    size_t offset; // Number of bytes that are used in the current block
+    size_t usedBefore; // Number of bytes that were used in the blocks before the current one
+    size_t peak;
+
+    void* allocate(size_t size, size_t align);
+};
+}
+
+#endif //RCPSPT_EXACT_ARENA_H
@@ -20,33 +20,21 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 **************************************************************************************************/
 
+#include <algorithm>
+#include <cstdint>
+
 #include "BDD.h"
 
 using namespace RcpsptExact;
 
 BDD::BDD(bool termValue)
-        : selector({-1,-1}), fBranch(nullptr), tBranch(nullptr), visited(false), auxYices(-1), auxWcnf(-1) {
+        : layer(-1), selector({-1,-1}), fBranch(nullptr), tBranch(nullptr), visited(false) {
     if (termValue) term = 1;
     else term = 0;
 }
 
-BDD::BDD(const pair<int, int> &selector, BDD *falseBranch, BDD *trueBranch)
-        : selector(selector), fBranch(falseBranch), tBranch(trueBranch), term(-1), visited(false), auxYices(-1), auxWcnf(-1) {}
-
-term_t BDD::getAuxYices(int* measure_bools) {
-    if (auxYices == -1) {
-        auxYices = yices_new_uninterpreted_term(yices_bool_type());
-        (*measure_bools)++;
-    }
-    return auxYices;
-}
-
-int BDD::getAuxWcnf(int* nextIndex) {
-    if (auxWcnf == -1) {
-        auxWcnf = (*nextIndex)++;
-    }
-    return auxWcnf;
-}
+BDD::BDD(int layer, const pair<int, int> &selector, BDD *falseBranch, BDD *trueBranch)
+        : layer(layer), selector(selector), fBranch(falseBranch), tBranch(trueBranch), term(-1), visited(false) {}
 
 bool BDD::terminal() const {
     return term != -1;
@@ -71,66 +59,32 @@ int BDD::flatten(vector<BDD *> &out) {
     return rootIndex;
 }
 
-LSet::LSet(const pair<int, int> &interval, BDD *robdd)
-        : interval(interval), robdd(robdd), l(nullptr), r(nullptr) { }
-
-bool LSet::insert(const pair<int, int> &newInterval, BDD *newRobdd) {
-    if (newInterval == interval) return false;
-    if (newInterval.second < interval.first) {
-        if (l == nullptr) {
-            l = new LSet(newInterval, newRobdd);
-            return true;
-        }
-        else return l->insert(newInterval, newRobdd);
-    }
-    if (newInterval.first > interval.second) {
-        if (r == nullptr) {
-            r = new LSet(newInterval, newRobdd);
-            return true;
-        }
-        else return r->insert(newInterval, newRobdd);
+void BDD::initLayers(const PBConstr& C, BDD* falseNode, BDD* trueNode, vector<LSet<BDD>>& L) {
+    if ((int)L.size() < C.nTerms() + 1) L.resize(C.nTerms() + 1);
+    int constsSum = 0; // Sum of the constants of the terms from i onwards
+    for (int i = C.nTerms(); i >= 0; i--) {
+        if (i < C.nTerms()) constsSum += C.constant(i);
+        L[i].clear();
+        L[i].insert({INT32_MIN/2, -1}, falseNode);
+        L[i].insert({constsSum, INT32_MAX/2}, trueNode);
     }
-
-    std::cerr << "Invalid call to LSet::insert" << std::endl;
-    return false;
-}
-
-pair<pair<int, int>, BDD *> LSet::search(int K) const {
-    if (interval.first <= K && K <= interval.second) return {interval, robdd};
-    if (K < interval.first && l != nullptr) return l->search(K);
-    if (K > interval.second && r != nullptr) return r->search(K);
-    return {{-1,-1}, nullptr};
 }
 
-void LSet::deleteTree() {
-    if (l != nullptr) l->deleteTree();
-    delete l;
-    l = nullptr;
-    if (r != nullptr) r->deleteTree();
-    delete r;
-    r = nullptr;
-}
-
-pair<pair<int,int>,BDD*> BDD::BDDConstruction(int i, const PBConstr& C, int KPrime, vector<LSet>& L) {
+pair<pair<int,int>,BDD*> BDD::BDDConstruction(int i, const PBConstr& C, int KPrime, vector<LSet<BDD>>& L, Arena& arena) {
     // This function is fully based on Algorithm 2 in the paper by I. Abío et al. (2012) (reference in README.md)
 
     pair<pair<int,int>,BDD*> result = L[i].search(KPrime);
     if (result.second != nullptr) return result;
 
-    pair<pair<int,int>, BDD*> resF = BDDConstruction(i+1, C, KPrime, L);
-    pair<pair<int,int>, BDD*> resT = BDDConstruction(i+1, C, KPrime - C.constant(i), L);
+    pair<pair<int,int>, BDD*> resF = BDDConstruction(i+1, C, KPrime, L, arena);
+    pair<pair<int,int>, BDD*> resT = BDDConstruction(i+1, C, KPrime - C.constant(i), L, arena);
 
     if (resF.first == resT.first) {
     result = { { resT.first.first + C.constant(i), resT.first.second }, resT.second };
-
-    if (resT.second != resF.second && resF.second != nullptr) {
-        vector<BDD*> nodesToDelete;
-        resF.second->flatten(nodesToDelete);
-        for (BDD* node : nodesToDelete) if (!node->terminal()) delete node;
-    }
+    // Nodes of resF that are no longer used are released together with the arena
     }
     else {
-        BDD* robdd = new BDD(C.var(i), resF.second, resT.second);
+        BDD* robdd = arena.make<BDD>(i, C.var(i), resF.second, resT.second);
         int intervalL = std::max(resF.first.first, resT.first.first + C.constant(i));
         int intervalR = std::min(resF.first.second, resT.first.second + C.constant(i));
         result = {{intervalL, intervalR}, robdd};
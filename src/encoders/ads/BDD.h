@@ -26,15 +26,14 @@ SOFTWARE.
 #include <iostream>
 #include <vector>
 
+#include "Arena.h"
+#include "LSet.h"
 #include "PBConstr.h"
-#include "yices.h"
 
 using namespace std;
 
 namespace RcpsptExact {
 
-class LSet;
-
 /**
  * Data structure representing a Binary Decision Diagram.
  */
@@ -50,52 +49,40 @@ public:
     /**
      * Construct a non-terminal node.
      *
+     * @param layer index of the term in the PB constraint that is represented by this node
      * @param selector variable in the PB constraint that is represented by this node
      * @param falseBranch BDD corresponding to 'False' assignment
      * @param trueBranch BDD corresponding to 'True' assignment
      */
-    BDD(const pair<int,int>& selector, BDD* falseBranch, BDD* trueBranch);
+    BDD(int layer, const pair<int,int>& selector, BDD* falseBranch, BDD* trueBranch);
 
+    const int layer; // Index of the term in the PB constraint (-1 for terminal nodes)
     const pair<int,int> selector; // Index of the decision variable y_(i,t)
     BDD* fBranch; // Child for the 'False' branch
     BDD* tBranch; // Child for the 'True' branch
 
-    term_t getAuxYices(int* measure_bools);
-
-    int getAuxWcnf(int* nextIndex);
-
     bool terminal() const;
 
     bool terminalValue() const;
 
     int flatten(vector<BDD*>& out);
 
-    static pair<pair<int,int>, BDD*> BDDConstruction(int i, const PBConstr& C, int KPrime, vector<LSet>& L);
+    /**
+     * Constructs the ROBDD for a PB constraint, see Algorithm 2 in the paper by I. Abío et al. (2012) (reference in README.md).
+     * All nodes are allocated in the arena, they are released when the arena is reset. L is prepared by initLayers().
+     */
+    static pair<pair<int,int>, BDD*> BDDConstruction(int i, const PBConstr& C, int KPrime, vector<LSet<BDD>>& L, Arena& arena);
+
+    /**
+     * Prepares the layers L for BDDConstruction: layer i initially contains the terminal nodes, for the intervals in
+     * which the terms from i onwards can never (false) or always (true) satisfy the constraint.
+     * The layers are reused when L is already large enough.
+     */
+    static void initLayers(const PBConstr& C, BDD* falseNode, BDD* trueNode, vector<LSet<BDD>>& L);
 
 private:
     int term; // Indicates whether the node is terminal: -1 not terminal, 0 terminal w/ val. False, 1 terminal w/ val. True
     bool visited; // Indicates whether the node has been visited (used for flatten(out))
-    term_t auxYices; // Auxiliary Boolean variable used for creating a SAT encoding of an ROBDD (only for Yices encoders)
-    int auxWcnf; // Index of auxiliary Boolean variable used for creating a SAT encoding of an ROBDD (only for WCNF encoder)
-};
-
-/**
- * Binary tree-like data structure representing a set of pairs (interval, robdd).
- */
-class LSet {
-public:
-    LSet(const pair<int,int>& interval, BDD* robdd);
-
-    pair<int,int> interval; // Interval of the ROBDD
-    BDD* robdd; // Reduced Ordered BDD
-    LSet* l;
-    LSet* r;
-
-    bool insert(const pair<int,int>& newInterval, BDD* newRobdd);
-
-    pair<pair<int,int>,BDD*> search(int K) const;
-
-    void deleteTree();
 };
 }
 
@@ -0,0 +1,105 @@
+/*********************************************************************************[ClauseBuffer.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#include <algorithm>
+
+#include "ClauseBuffer.h"
+
+using namespace RcpsptExact;
+
+void ClauseBuffer::emit(ClauseSink& sink, int first) const {
+    for (int c = first; c < size(); c++) sink.clause(clause(c), clauseSize(c));
+}
+
+uint32_t ClauseBuffer::hash(int c) const {
+    // Multiplicative hashing of the literals in order, with a final mix so that all bits depend on all literals
+    uint64_t hash = (uint64_t)clauseSize(c);
+    for (const int* l = clause(c); l != clause(c) + clauseSize(c); l++)
+        hash = (hash + (uint32_t)*l) * 0x9e3779b97f4a7c15;
+    return (uint32_t)(hash ^ (hash >> 32));
+}
+
+int ClauseBuffer::deduplicate() {
+    int n = size();
+    if (stream != nullptr || n < 2) return 0;
+
+    // Partition the clauses by the highest bits of their hash (a counting sort), with about 1024 clauses per bucket
+    int bits = 0;
+    while (bits < 20 && (n >> (bits + 10)) > 0) bits++;
+    auto bucket = [bits](uint32_t h) { return (int)((uint64_t)h >> (32 - bits)); };
+    vector<int> bucketStart((1 << bits) + 1, 0);
+    for (int c = 0; c < n; c++) bucketStart[bucket(hash(c)) + 1]++;
+    for (int b = 0; b < (1 << bits); b++) bucketStart[b + 1] += bucketStart[b];
+
+    // The hashes are computed again rather than stored, which is cheaper than the memory for them on large buffers.
+    // The keys have the hash in the high bits and the index in the low bits. The counting sort is stable, so each
+    // bucket is in the order in which the clauses were added
+    vector<uint64_t> keys(n);
+    vector<int> next(bucketStart.begin(), bucketStart.end() - 1);
+    int maxBucket = 0;
+    for (int b = 0; b < (1 << bits); b++) maxBucket = max(maxBucket, bucketStart[b + 1] - bucketStart[b]);
+    for (int c = 0; c < n; c++) {
+        uint32_t h = hash(c);
+        keys[next[bucket(h)]++] = (uint64_t)h << 32 | (uint32_t)c;
+    }
+
+    // Mark the duplicates in each bucket using a small hash table (with linear probing) of the positions in keys of
+    // the clauses of the bucket that were kept
+    size_t tableSize = 1;
+    while (tableSize < 2 * (size_t)maxBucket) tableSize *= 2;
+    vector<int> table(tableSize);
+    vector<char> duplicate(n, false);
+    int removed = 0;
+    for (int b = 0; b < (1 << bits); b++) {
+        fill(table.begin(), table.end(), -1);
+        for (int k = bucketStart[b]; k < bucketStart[b + 1]; k++) {
+            int c = (int)(uint32_t)keys[k];
+            size_t slot = (keys[k] >> 32) & (tableSize - 1);
+            for (; table[slot] != -1; slot = (slot + 1) & (tableSize - 1)) {
+                uint64_t other = keys[table[slot]];
+                int d = (int)(uint32_t)other;
+                if (other >> 32 == keys[k] >> 32 && clauseSize(d) == clauseSize(c)
+                        && equal(clause(d), clause(d) + clauseSize(d), clause(c))) {
+                    duplicate[c] = true;
+                    removed++;
+                    break;
+                }
+            }
+            if (!duplicate[c]) table[slot] = k;
+        }
+    }
+    keys = vector<uint64_t>();
+    if (removed == 0) return 0;
+
+    // Compact the remaining clauses
+    size_t end = 0;
+    int m = 0;
+    for (int c = 0; c < n; c++) {
+        if (duplicate[c]) continue;
+        size_t begin = offsets[c], clauseEnd = offsets[c + 1];
+        for (size_t l = begin; l < clauseEnd; l++) lits[end++] = lits[l];
+        offsets[++m] = end;
+    }
+    lits.resize(end);
+    offsets.resize(m + 1);
+    return removed;
+}
@@ -0,0 +1,124 @@
+/**********************************************************************************[ClauseBuffer.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#ifndef RCPSPT_EXACT_CLAUSEBUFFER_H
+#define RCPSPT_EXACT_CLAUSEBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+using namespace std;
+
+namespace RcpsptExact {
+
+/**
+ * Receiver of the clauses of a ClauseBuffer, which outputs them to some backend (a solver, a file, ...).
+ * Literals are variables numbered from 1, negated if negative.
+ */
+class ClauseSink {
+public:
+    virtual ~ClauseSink() = default;
+
+    virtual void clause(const int* lits, int n) = 0;
+};
+
+/**
+ * Clauses stored as one flat array of literals, with the offset of the first literal of each clause.
+ * Literals are variables numbered from 1, negated if negative. Clauses that were added more than once (with the same
+ * literals in the same order) can be removed afterwards with deduplicate.
+ *
+ * Alternatively, the clauses can be streamed to a sink as soon as they are added, without storing them. This avoids
+ * keeping all clauses in memory when they are only output once (such as to a WCNF file), but they cannot be
+ * deduplicated then.
+ */
+class ClauseBuffer {
+public:
+    /**
+     * @param stream sink to pass each clause on to as soon as it is added instead of storing it, nullptr to store the clauses
+     */
+    explicit ClauseBuffer(ClauseSink* stream = nullptr) : stream(stream) {}
+
+    /**
+     * Reserves a number of new variables.
+     *
+     * @return the first of the new variables
+     */
+    int newVars(int n) {
+        int first = nvars + 1;
+        nvars += n;
+        return first;
+    }
+
+    int nVars() const { return nvars; }
+
+    void add(initializer_list<int> clause) { add(clause.begin(), clause.end()); }
+
+    template<typename It>
+    void add(It first, It last) {
+        if (stream != nullptr) {
+            lits.assign(first, last);
+            stream->clause(lits.data(), (int)lits.size());
+            nstreamed++;
+            return;
+        }
+        lits.insert(lits.end(), first, last);
+        offsets.push_back(lits.size());
+    }
+
+    /**
+     * Removes every clause that is equal to a clause that was added before it, keeping the order of the other clauses.
+     * Instead of probing a hash table for every clause, which costs a cache miss per clause for large buffers, the
+     * clauses are partitioned by hash into buckets that fit in the cache, and each bucket is sorted by hash.
+     *
+     * @return the number of removed clauses (always 0 if the clauses are streamed)
+     */
+    int deduplicate();
+
+    /**
+     * @return the number of clauses (that have been streamed)
+     */
+    int size() const { return stream != nullptr ? nstreamed : (int)offsets.size() - 1; }
+
+    const int* clause(int c) const { return lits.data() + offsets[c]; }
+
+    int clauseSize(int c) const { return (int)(offsets[c + 1] - offsets[c]); }
+
+    /**
+     * Outputs the clauses from index first onwards to a sink, in the order in which they were added (not possible if
+     * the clauses are streamed).
+     */
+    void emit(ClauseSink& sink, int first = 0) const;
+
+private:
+    ClauseSink* stream;
+    int nstreamed = 0;
+    int nvars = 0;
+    vector<int> lits; // Literals of all clauses (only the current one if the clauses are streamed)
+    vector<size_t> offsets = {0}; // Index in lits of the first literal of each clause, and the end of the last one
+
+    uint32_t hash(int c) const;
+};
+}
+
+#endif //RCPSPT_EXACT_CLAUSEBUFFER_H
@@ -0,0 +1,88 @@
+/******************************************************************************************[LSet.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#ifndef RCPSPT_EXACT_LSET_H
+#define RCPSPT_EXACT_LSET_H
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+namespace RcpsptExact {
+
+/**
+ * Set of pairs (interval, node) for one layer of the construction of a decision diagram (BDD or MDD), with disjoint
+ * intervals. The pairs are kept in flat arrays sorted by interval, so that searching is a binary search over contiguous
+ * memory. Clearing keeps the allocated memory, so the layers can be reused for the next PB constraint.
+ */
+template<typename Node>
+class LSet {
+public:
+    /**
+     * Adds a pair, if there is no pair with the same interval yet.
+     *
+     * @return true if the pair was added
+     */
+    bool insert(const pair<int,int>& newInterval, Node* newNode) {
+        // Position of the first interval that lies to the right of the new one
+        auto it = upper_bound(lefts.begin(), lefts.end(), newInterval.first);
+        size_t pos = it - lefts.begin();
+        if (pos > 0 && lefts[pos - 1] == newInterval.first && rights[pos - 1] == newInterval.second) return false;
+        if ((pos > 0 && rights[pos - 1] >= newInterval.first) || (pos < lefts.size() && lefts[pos] <= newInterval.second)) {
+            std::cerr << "Invalid call to LSet::insert" << std::endl;
+            return false;
+        }
+        lefts.insert(lefts.begin() + pos, newInterval.first);
+        rights.insert(rights.begin() + pos, newInterval.second);
+        nodes.insert(nodes.begin() + pos, newNode);
+        return true;
+    }
+
+    /**
+     * @return the pair of which the interval contains K, or ({-1,-1}, nullptr) if there is none
+     */
+    pair<pair<int,int>,Node*> search(int K) const {
+        // The only interval that can contain K is the last one that starts at or before K
+        size_t pos = upper_bound(lefts.begin(), lefts.end(), K) - lefts.begin();
+        if (pos > 0 && K <= rights[pos - 1]) return {{lefts[pos - 1], rights[pos - 1]}, nodes[pos - 1]};
+        return {{-1,-1}, nullptr};
+    }
+
+    /**
+     * Removes all pairs.
+     */
+    void clear() {
+        lefts.clear();
+        rights.clear();
+        nodes.clear();
+    }
+
+private:
+    vector<int> lefts; // Left ends of the intervals, in ascending order
+    vector<int> rights; // Right ends of the intervals
+    vector<Node*> nodes; // Reduced decision diagram for each interval
+};
+}
+
+#endif //RCPSPT_EXACT_LSET_H
@@ -0,0 +1,114 @@
+/******************************************************************************************[MDD.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#include <algorithm>
+#include <cstdint>
+
+#include "MDD.h"
+
+using namespace RcpsptExact;
+
+MDD::MDD(bool termValue)
+        : layer(-1), noneBranch(nullptr), branches(nullptr), nBranches(0), visited(false) {
+    if (termValue) term = 1;
+    else term = 0;
+}
+
+MDD::MDD(int layer, MDD* noneBranch, MDD** branches, int nBranches)
+        : layer(layer), noneBranch(noneBranch), branches(branches), nBranches(nBranches), term(-1), visited(false) {}
+
+bool MDD::terminal() const {
+    return term != -1;
+}
+
+bool MDD::terminalValue() const {
+    return term == 1;
+}
+
+int MDD::flatten(vector<MDD*>& out) {
+    visited = true;
+    int rootIndex;
+    if (terminal()) {
+        rootIndex = (int)out.size();
+        out.push_back(this);
+        return rootIndex;
+    }
+    if (!noneBranch->visited) noneBranch->flatten(out);
+    rootIndex = (int)out.size();
+    out.push_back(this);
+    for (int b = 0; b < nBranches; b++) {
+        if (!branches[b]->visited) branches[b]->flatten(out);
+    }
+    return rootIndex;
+}
+
+vector<int> MDD::groups(const PBConstr& C) {
+    vector<int> groups;
+    for (int i = 0; i < C.nTerms(); i++) {
+        if (i == 0 || C.var(i).first != C.var(i - 1).first) groups.push_back(i);
+    }
+    groups.push_back(C.nTerms());
+    return groups;
+}
+
+void MDD::initLayers(const PBConstr& C, const vector<int>& groups, MDD* falseNode, MDD* trueNode, vector<LSet<MDD>>& L) {
+    int ngroups = (int)groups.size() - 1;
+    if ((int)L.size() < ngroups + 1) L.resize(ngroups + 1);
+    int maxSum = 0; // Largest sum of the terms from group g onwards
+    for (int g = ngroups; g >= 0; g--) {
+        if (g < ngroups) {
+            int largest = 0;
+            for (int i = groups[g]; i < groups[g + 1]; i++) largest = max(largest, C.constant(i));
+            maxSum += largest;
+        }
+        L[g].clear();
+        L[g].insert({INT32_MIN/2, -1}, falseNode);
+        L[g].insert({maxSum, INT32_MAX/2}, trueNode);
+    }
+}
+
+pair<pair<int,int>,MDD*> MDD::MDDConstruction(int g, const PBConstr& C, const vector<int>& groups, int KPrime,
+                                              vector<LSet<MDD>>& L, Arena& arena) {
+    pair<pair<int,int>,MDD*> result = L[g].search(KPrime);
+    if (result.second != nullptr) return result;
+
+    // The node is valid for the intersection of the intervals of its children (shifted by the constants of the terms)
+    pair<pair<int,int>,MDD*> resNone = MDDConstruction(g+1, C, groups, KPrime, L, arena);
+    pair<int,int> interval = resNone.first;
+    int first = groups[g], nBranches = groups[g+1] - groups[g];
+    MDD** branches = arena.makeArray<MDD*>(nBranches);
+    bool reduce = true; // Whether all branches lead to the same child, so that the node is redundant
+    for (int b = 0; b < nBranches; b++) {
+        int constant = C.constant(first + b);
+        pair<pair<int,int>,MDD*> res = MDDConstruction(g+1, C, groups, KPrime - constant, L, arena);
+        branches[b] = res.second;
+        interval.first = max(interval.first, res.first.first + constant);
+        interval.second = min(interval.second, res.first.second + constant);
+        if (res.second != resNone.second) reduce = false;
+    }
+
+    if (reduce) result = {interval, resNone.second};
+    else result = {interval, arena.make<MDD>(g, resNone.second, branches, nBranches)};
+
+    L[g].insert(result.first, result.second);
+    return result;
+}
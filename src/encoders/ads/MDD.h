@@ -0,0 +1,105 @@
+/*******************************************************************************************[MDD.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#ifndef RCPSPT_EXACT_MDD_H
+#define RCPSPT_EXACT_MDD_H
+
+#include <vector>
+
+#include "Arena.h"
+#include "LSet.h"
+#include "PBConstr.h"
+
+using namespace std;
+
+namespace RcpsptExact {
+
+/**
+ * Data structure representing a Multi-valued Decision Diagram for a PB constraint, in which each layer corresponds to
+ * a group of consecutive terms of which at most one can be true: the start variables y_(i,t) of one activity i (an
+ * activity starts exactly once). A node has one branch for each term of its group, and one for none of them.
+ */
+class MDD {
+public:
+    /**
+     * Construct a terminal node.
+     *
+     * @param termValue boolean value of the node
+     */
+    MDD(bool termValue);
+
+    /**
+     * Construct a non-terminal node.
+     *
+     * @param layer index of the group of terms that is represented by this node
+     * @param noneBranch MDD corresponding to all terms of the group being false
+     * @param branches MDD corresponding to each term of the group being true
+     * @param nBranches number of terms in the group
+     */
+    MDD(int layer, MDD* noneBranch, MDD** branches, int nBranches);
+
+    const int layer; // Index of the group of terms (-1 for terminal nodes)
+    MDD* noneBranch; // Child for the assignment in which all terms of the group are false
+    MDD** branches; // Child for each term of the group being true
+    const int nBranches;
+
+    bool terminal() const;
+
+    bool terminalValue() const;
+
+    /**
+     * Adds the nodes that have not been visited yet to out, in the order: none branch, node, other branches.
+     *
+     * @return index of this node in out
+     */
+    int flatten(vector<MDD*>& out);
+
+    /**
+     * Splits the terms of a PB constraint into groups of consecutive terms for the same activity.
+     *
+     * @return index of the first term of each group, followed by the number of terms
+     */
+    static vector<int> groups(const PBConstr& C);
+
+    /**
+     * Constructs the reduced MDD for a PB constraint, following Algorithm 2 in the paper by I. Abío et al. (2012)
+     * (reference in README.md) with one branch per term of a group instead of a true and a false branch.
+     * All nodes are allocated in the arena, they are released when the arena is reset. L is prepared by initLayers().
+     */
+    static pair<pair<int,int>, MDD*> MDDConstruction(int g, const PBConstr& C, const vector<int>& groups, int KPrime,
+                                                     vector<LSet<MDD>>& L, Arena& arena);
+
+    /**
+     * Prepares the layers L for MDDConstruction: layer g initially contains the terminal nodes, for the intervals in
+     * which the groups from g onwards can never (false) or always (true) satisfy the constraint. Since at most one term
+     * of each group is true, the latter is the case when K is at least the sum of the largest constant of each group.
+     * The layers are reused when L is already large enough.
+     */
+    static void initLayers(const PBConstr& C, const vector<int>& groups, MDD* falseNode, MDD* trueNode, vector<LSet<MDD>>& L);
+
+private:
+    int term; // Indicates whether the node is terminal: -1 not terminal, 0 terminal w/ val. False, 1 terminal w/ val. True
+    bool visited; // Indicates whether the node has been visited (used for flatten(out))
+};
+}
+
+#endif //RCPSPT_EXACT_MDD_H
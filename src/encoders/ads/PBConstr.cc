@@ -24,23 +24,11 @@ SOFTWARE.
 
 using namespace RcpsptExact;
 
-PBConstr::PBConstr(int K)
-        : K(K), n(0) { }
-
-int PBConstr::nTerms() const {
-    return n;
-}
-
-void PBConstr::addTerm(int constant, pair<int, int> varIndex) {
-    q.push_back(constant);
-    y_ixs.push_back(varIndex);
-    n++;
-}
-
-int PBConstr::constant(int i) const {
-    return q[i];
+void PBConstrList::begin(int K) {
+    Ks.push_back(K);
 }
 
-const pair<int,int>& PBConstr::var(int i) const {
-    return y_ixs[i];
+void PBConstrList::end() {
+    if ((int)terms.size() == offsets.back()) Ks.pop_back();
+    else offsets.push_back((int)terms.size());
 }
@@ -29,23 +29,24 @@ using namespace std;
 
 namespace RcpsptExact {
 /**
- * Data structure representing a pseudo-boolean (PB) constraint.
+ * Term of a pseudo-boolean (PB) constraint: an integer constant times a boolean variable.
+ */
+struct PBTerm {
+    int constant; // The integer constant
+    pair<int,int> var; // Index of the boolean variable
+};
+
+/**
+ * Data structure representing a pseudo-boolean (PB) constraint: sum of the terms <= K.
+ * It is a view on the terms that are stored in a PBConstrList.
  */
 class PBConstr {
 public:
     const int K;
 
-    PBConstr(int K);
+    PBConstr(int K, const PBTerm* terms, int n) : K(K), terms(terms), n(n) {}
 
-    int nTerms() const;
-
-    /**
-     * Adds a term to the summation.
-     *
-     * @param constant the integer constant
-     * @param varIndex index of the boolean variable
-     */
-    void addTerm(int constant, pair<int,int> varIndex);
+    int nTerms() const { return n; }
 
     /**
      * Gets the integer constant at index i in the summation.
@@ -53,21 +54,56 @@ public:
      * @param i index
      * @return the integer constant
      */
-    int constant(int i) const;
+    int constant(int i) const { return terms[i].constant; }
 
     /**
      * Gets the index of the boolean variable at index i in the summation.
      *
-     * @param i
-     * @return
+     * @param i index
+     * @return the index of the boolean variable
      */
-    const pair<int,int>& var(int i) const;
+    const pair<int,int>& var(int i) const { return terms[i].var; }
 
 private:
-    vector<int> q;
-    vector<pair<int,int>> y_ixs;
+    const PBTerm* terms;
     int n;
 };
+
+/**
+ * List of PB constraints, of which the terms are stored in one flat array (CSR-style, with an offset per constraint).
+ * Constraints are added one at a time: begin(K), then addTerm() for each term, then end().
+ */
+class PBConstrList {
+public:
+    /**
+     * Starts a new constraint.
+     *
+     * @param K the right-hand side of the constraint
+     */
+    void begin(int K);
+
+    /**
+     * Adds a term to the constraint that was started last.
+     *
+     * @param constant the integer constant
+     * @param varIndex index of the boolean variable
+     */
+    void addTerm(int constant, pair<int,int> varIndex) { terms.push_back({constant, varIndex}); }
+
+    /**
+     * Finishes the constraint that was started last, it is dropped if it does not have any terms.
+     */
+    void end();
+
+    int size() const { return (int)Ks.size(); }
+
+    PBConstr operator[](int c) const { return {Ks[c], &terms[offsets[c]], offsets[c + 1] - offsets[c]}; }
+
+private:
+    vector<int> Ks; // Right-hand side of each constraint
+    vector<int> offsets = {0}; // Index of the first term of each constraint, and the end of the last one
+    vector<PBTerm> terms; // Terms of all constraints
+};
 }
 
 #endif //RCPSPT_EXACT_PBCONSTR_H
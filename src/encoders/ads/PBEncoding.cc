@@ -0,0 +1,491 @@
+/***********************************************************************************[PBEncoding.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+
+#include "PBEncoding.h"
+
+using namespace RcpsptExact;
+
+namespace {
+const int FALSE_LIT = 0; // Constant false, for the inputs of comparators and adders (never part of a clause)
+
+/**
+ * Adds the clauses of an encoding to a PBEncoding, or only counts them (when out is nullptr).
+ * Counting stops being useful once the limit on the number of clauses is exceeded, see exceeded().
+ */
+class ClauseBuilder {
+public:
+    ClauseBuilder(PBEncoding* out, int nTerms, long limit) : out(out), nTerms(nTerms), limit(limit) {}
+
+    int newAux() {
+        size.vars++;
+        return out != nullptr ? out->newAux() : nTerms + (int)size.vars;
+    }
+
+    void add(initializer_list<int> clause) {
+        size.clauses++;
+        if (out != nullptr) out->addClause(clause.begin(), clause.end());
+    }
+
+    void add(const vector<int>& clause) {
+        size.clauses++;
+        if (out != nullptr) out->addClause(clause.begin(), clause.end());
+    }
+
+    bool exceeded() const { return size.clauses > limit; }
+
+    PBEncodingSize result() const {
+        PBEncodingSize result = size;
+        result.applicable = !exceeded();
+        return result;
+    }
+
+private:
+    PBEncoding* out;
+    int nTerms;
+    long limit;
+    PBEncodingSize size;
+};
+
+/**
+ * Generalized totalizer over the terms [lo, hi): determines the sums (capped at K+1) that the terms can reach, and for
+ * each of them the literal that is implied when the terms reach at least that sum. For a single term this is its own
+ * variable, otherwise it is a new auxiliary variable for which the clauses are added.
+ */
+void totalize(const vector<int>& weights, int K, int lo, int hi, ClauseBuilder& b, vector<int>& sums, vector<int>& lits) {
+    sums.clear();
+    lits.clear();
+    if (hi - lo == 1) {
+        sums.push_back(min(weights[lo], K + 1));
+        lits.push_back(lo + 1);
+        return;
+    }
+    int mid = (lo + hi) / 2;
+    vector<int> sumsA, litsA, sumsB, litsB;
+    totalize(weights, K, lo, mid, b, sumsA, litsA);
+    if (b.exceeded()) return;
+    totalize(weights, K, mid, hi, b, sumsB, litsB);
+    if (b.exceeded()) return;
+
+    // Each sum of the node is reached by a sum of one child, or by a sum of each of them (index -1 for no sum)
+    vector<int> index(K + 2, -1);
+    for (int i = -1; i < (int)sumsA.size(); i++) {
+        for (int j = -1; j < (int)sumsB.size(); j++) {
+            if (i == -1 && j == -1) continue;
+            index[min((i >= 0 ? sumsA[i] : 0) + (j >= 0 ? sumsB[j] : 0), K + 1)] = 0;
+        }
+    }
+    for (int s = 1; s <= K + 1; s++) {
+        if (index[s] == -1) continue;
+        index[s] = (int)sums.size();
+        sums.push_back(s);
+        lits.push_back(b.newAux());
+    }
+    for (int i = -1; i < (int)sumsA.size(); i++) {
+        for (int j = -1; j < (int)sumsB.size(); j++) {
+            if (i == -1 && j == -1) continue;
+            int out = lits[index[min((i >= 0 ? sumsA[i] : 0) + (j >= 0 ? sumsB[j] : 0), K + 1)]];
+            if (i == -1) b.add({-litsB[j], out});
+            else if (j == -1) b.add({-litsA[i], out});
+            else b.add({-litsA[i], -litsB[j], out});
+        }
+        if (b.exceeded()) return;
+    }
+}
+
+/**
+ * Generalized totalizer for the constraint sum(weights[i] * x_i) <= K.
+ */
+void generalizedTotalizer(const vector<int>& weights, int K, ClauseBuilder& b) {
+    vector<int> sums, lits;
+    totalize(weights, K, 0, (int)weights.size(), b, sums, lits);
+    if (!b.exceeded() && sums.back() == K + 1) b.add({-lits.back()});
+}
+
+/**
+ * Odd-even merge sorting network (K. E. Batcher, 1968) for the constraint sum(x_i) <= k, over n inputs. Each comparator
+ * only implies its outputs from its inputs, which is sufficient for an upper bound. Comparators of which no output is
+ * needed for the (k+1)-th largest output are left out, as are comparators with a constant false input.
+ */
+void sortingNetwork(int n, int k, ClauseBuilder& b) {
+    struct Comparator {
+        int a, b, max, min;
+    };
+    int N = 1;
+    while (N < n) N <<= 1;
+    vector<int> wires(N, FALSE_LIT); // Current value on each wire: a term variable, an output of a comparator, or FALSE_LIT
+    for (int i = 0; i < n; i++) wires[i] = i + 1;
+    vector<Comparator> comparators;
+    int nextId = n + 1; // Outputs of comparators are numbered after the term variables
+    auto compare = [&](int x, int y) { // Puts the largest value on wire x
+        int a = wires[x], c = wires[y];
+        if (a == FALSE_LIT) swap(wires[x], wires[y]);
+        else if (c != FALSE_LIT) {
+            comparators.push_back({a, c, nextId, nextId + 1});
+            wires[x] = nextId++;
+            wires[y] = nextId++;
+        }
+    };
+    for (int p = 1; p < N; p <<= 1) {
+        for (int d = p; d >= 1; d >>= 1) {
+            for (int j = d % p; j + d < N; j += 2 * d) {
+                for (int i = 0; i < d && i + j + d < N; i++) {
+                    if ((i + j) / (2 * p) == (i + j + d) / (2 * p)) compare(i + j, i + j + d);
+                }
+            }
+        }
+    }
+
+    // Determine the outputs that are needed, from the (k+1)-th largest output backwards
+    vector<char> needed(nextId, false);
+    needed[wires[k]] = true;
+    for (auto it = comparators.rbegin(); it != comparators.rend(); ++it) {
+        if (needed[it->max] || needed[it->min]) needed[it->a] = needed[it->b] = true;
+    }
+    vector<int> lit(nextId); // Literal for each term variable and each needed output
+    for (int i = 1; i <= n; i++) lit[i] = i;
+    for (const Comparator& c : comparators) {
+        if (needed[c.max]) {
+            lit[c.max] = b.newAux();
+            b.add({-lit[c.a], lit[c.max]});
+            b.add({-lit[c.b], lit[c.max]});
+        }
+        if (needed[c.min]) {
+            lit[c.min] = b.newAux();
+            b.add({-lit[c.a], -lit[c.b], lit[c.min]});
+        }
+        if (b.exceeded()) return;
+    }
+    b.add({-lit[wires[k]]});
+}
+
+/**
+ * Adds the clauses for out <=> (the number of true inputs is odd).
+ */
+void addParity(const vector<int>& inputs, int out, ClauseBuilder& b) {
+    int n = (int)inputs.size();
+    for (int mask = 0; mask < (1 << n); mask++) { // Exclude each assignment of the inputs together with the wrong output
+        bool odd = __builtin_popcount(mask) % 2 == 1;
+        int l[3];
+        for (int i = 0; i < n; i++) l[i] = (mask >> i) & 1 ? -inputs[i] : inputs[i];
+        if (n == 2) b.add({l[0], l[1], odd ? out : -out});
+        else b.add({l[0], l[1], l[2], odd ? out : -out});
+    }
+}
+
+/**
+ * Adder encoding for the constraint sum(weights[i] * x_i) <= K: the bits of the weights are summed by full and half
+ * adders, and the resulting binary number is compared with K.
+ */
+void adder(const vector<int>& weights, int K, ClauseBuilder& b) {
+    vector<deque<int>> buckets; // Literals to be summed, for each bit
+    for (int i = 0; i < (int)weights.size(); i++) {
+        if (weights[i] > K) { // The term can never be true
+            b.add({-(i + 1)});
+            continue;
+        }
+        for (int bit = 0; weights[i] >> bit; bit++) {
+            if (bit == (int)buckets.size()) buckets.emplace_back();
+            if ((weights[i] >> bit) & 1) buckets[bit].push_back(i + 1);
+        }
+    }
+    vector<int> bits; // Literal for each bit of the sum (FALSE_LIT if the bit is always 0)
+    for (int bit = 0; bit < (int)buckets.size(); bit++) {
+        while (buckets[bit].size() >= 2) {
+            int x = buckets[bit].front();
+            buckets[bit].pop_front();
+            int y = buckets[bit].front();
+            buckets[bit].pop_front();
+            int s = b.newAux(), c = b.newAux();
+            if (!buckets[bit].empty()) { // Full adder
+                int z = buckets[bit].front();
+                buckets[bit].pop_front();
+                addParity({x, y, z}, s, b);
+                b.add({-x, -y, c});
+                b.add({-x, -z, c});
+                b.add({-y, -z, c});
+                b.add({x, y, -c});
+                b.add({x, z, -c});
+                b.add({y, z, -c});
+            }
+            else { // Half adder
+                addParity({x, y}, s, b);
+                b.add({-x, -y, c});
+                b.add({x, -c});
+                b.add({y, -c});
+            }
+            buckets[bit].push_back(s);
+            if (bit + 1 == (int)buckets.size()) buckets.emplace_back();
+            buckets[bit + 1].push_back(c);
+            if (b.exceeded()) return;
+        }
+        bits.push_back(buckets[bit].empty() ? FALSE_LIT : buckets[bit].front());
+    }
+
+    // The sum exceeds K iff for some bit j that is 0 in K, bit j of the sum and all higher bits that are 1 in K are set
+    int B = (int)bits.size();
+    if ((K >> min(B, 30)) != 0) return; // The sum can never exceed K
+    for (int j = 0; j < B; j++) {
+        if ((K >> j) & 1 || bits[j] == FALSE_LIT) continue;
+        vector<int> clause = {-bits[j]};
+        bool satisfied = false;
+        for (int i = j + 1; i < B; i++) {
+            if (!((K >> i) & 1)) continue;
+            if (bits[i] == FALSE_LIT) satisfied = true;
+            clause.push_back(-bits[i]);
+        }
+        if (satisfied) continue;
+        b.add(clause);
+    }
+}
+}
+
+namespace {
+/**
+ * Upper bound on the number of non-terminal nodes of the ROBDD of a constraint: the nodes of layer i correspond to
+ * (intervals of) sums of the terms before i, so there are at most as many as there are reachable sums s for which
+ * the terms from i onwards can both satisfy and falsify the constraint.
+ */
+PBEncodingSize estimateBDD(const vector<int>& weights, int K, long limit) {
+    int n = (int)weights.size();
+    vector<long> suffix(n + 1, 0); // Sum of the constants of the terms from i onwards
+    for (int i = n - 1; i >= 0; i--) suffix[i] = suffix[i + 1] + weights[i];
+    vector<char> reached(K + 1, false); // Sums <= K that can be reached by the terms before i
+    reached[0] = true;
+    long nodes = 0;
+    for (int i = 0; i < n; i++) {
+        for (long s = max(0L, K - suffix[i] + 1); s <= K; s++) nodes += reached[s];
+        if (2 * nodes + 3 > limit) break;
+        for (int s = K; s >= weights[i]; s--) reached[s] |= reached[s - weights[i]];
+    }
+    PBEncodingSize size;
+    size.clauses = 2 * nodes + 3;
+    size.vars = nodes + 2;
+    size.applicable = size.clauses <= limit;
+    return size;
+}
+
+/**
+ * Upper bound on the number of non-terminal nodes of the MDD of a constraint, like estimateBDD but with one layer per
+ * group, in which at most one term is true. Each node has a clause for each term of its group, and one for none of them.
+ */
+PBEncodingSize estimateMDD(const vector<int>& weights, const vector<int>& groups, int K, long limit) {
+    int ngroups = (int)groups.size() - 1;
+    vector<long> suffix(ngroups + 1, 0); // Largest sum of the terms from group g onwards
+    for (int g = ngroups - 1; g >= 0; g--) {
+        suffix[g] = suffix[g + 1] + *max_element(weights.begin() + groups[g], weights.begin() + groups[g + 1]);
+    }
+    vector<char> reached(K + 1, false), next; // Sums <= K that can be reached by the groups before g
+    reached[0] = true;
+    PBEncodingSize size;
+    long nodes = 0;
+    for (int g = 0; g < ngroups; g++) {
+        long layerNodes = 0;
+        for (long s = max(0L, K - suffix[g] + 1); s <= K; s++) layerNodes += reached[s];
+        nodes += layerNodes;
+        size.clauses += layerNodes * (1 + groups[g + 1] - groups[g]);
+        if (size.clauses + 3 > limit) break;
+        next = reached;
+        for (int i = groups[g]; i < groups[g + 1]; i++) {
+            for (int s = K; s >= weights[i]; s--) next[s] |= reached[s - weights[i]];
+        }
+        swap(reached, next);
+    }
+    size.clauses += 3;
+    size.vars = nodes + 2;
+    size.applicable = size.clauses <= limit;
+    return size;
+}
+
+/**
+ * BDD-1: constructs the ROBDD, and adds the clauses following Example 24 in the paper by I. Abío et al. (2012).
+ * Auxiliary variables are numbered in the order of BDD::flatten, each node before its children.
+ */
+void encodeBDD(const PBConstr& C, PBWorkspace& workspace, PBEncoding& out) {
+    workspace.arena.reset();
+    BDD falseNode(false);
+    BDD trueNode(true);
+    BDD::initLayers(C, &falseNode, &trueNode, workspace.bddLayers);
+    BDD* robdd = BDD::BDDConstruction(0, C, C.K, workspace.bddLayers, workspace.arena).second;
+    vector<BDD*> nodes;
+    robdd->flatten(nodes);
+
+    unordered_map<const BDD*, int> aux;
+    auto getAux = [&](const BDD* node) {
+        auto it = aux.find(node);
+        if (it != aux.end()) return it->second;
+        return aux[node] = out.newAux();
+    };
+    for (BDD* node : nodes) {
+        if (node->terminal()) continue;
+        int auxNode = getAux(node);
+        out.addClause({getAux(node->fBranch), -auxNode});
+        out.addClause({getAux(node->tBranch), -(node->layer + 1), -auxNode});
+    }
+    out.addClause({getAux(robdd)});
+    out.addClause({-getAux(&falseNode)});
+    out.addClause({getAux(&trueNode)});
+}
+
+/**
+ * MDD: constructs the reduced MDD, and adds clauses like BDD-1: each node implies its none branch, and each term of its
+ * group together with the node implies the branch of that term (unless it is the same as the none branch).
+ */
+void encodeMDD(const PBConstr& C, const vector<int>& groups, PBWorkspace& workspace, PBEncoding& out) {
+    workspace.arena.reset();
+    MDD falseNode(false);
+    MDD trueNode(true);
+    MDD::initLayers(C, groups, &falseNode, &trueNode, workspace.mddLayers);
+    MDD* mdd = MDD::MDDConstruction(0, C, groups, C.K, workspace.mddLayers, workspace.arena).second;
+    vector<MDD*> nodes;
+    mdd->flatten(nodes);
+
+    unordered_map<const MDD*, int> aux;
+    auto getAux = [&](const MDD* node) {
+        auto it = aux.find(node);
+        if (it != aux.end()) return it->second;
+        return aux[node] = out.newAux();
+    };
+    for (MDD* node : nodes) {
+        if (node->terminal()) continue;
+        int auxNode = getAux(node);
+        out.addClause({getAux(node->noneBranch), -auxNode});
+        for (int b = 0; b < node->nBranches; b++) {
+            if (node->branches[b] == node->noneBranch) continue;
+            out.addClause({getAux(node->branches[b]), -(groups[node->layer] + b + 1), -auxNode});
+        }
+    }
+    out.addClause({getAux(mdd)});
+    out.addClause({-getAux(&falseNode)});
+    out.addClause({getAux(&trueNode)});
+}
+
+/**
+ * Constructs (out != nullptr) or counts an encoding other than BDD-1 and MDD.
+ */
+void build(PBEncodingType type, const vector<int>& weights, int K, ClauseBuilder& b) {
+    int n = (int)weights.size();
+    switch (type) {
+        case PBEncodingType::TOTALIZER:
+            generalizedTotalizer(vector<int>(n, 1), K / weights[0], b);
+            break;
+        case PBEncodingType::SORTING_NETWORK:
+            sortingNetwork(n, K / weights[0], b);
+            break;
+        case PBEncodingType::GENERALIZED_TOTALIZER:
+            generalizedTotalizer(weights, K, b);
+            break;
+        case PBEncodingType::ADDER:
+            adder(weights, K, b);
+            break;
+        default:
+            break;
+    }
+}
+
+vector<int> constants(const PBConstr& C) {
+    vector<int> weights(C.nTerms());
+    for (int i = 0; i < C.nTerms(); i++) weights[i] = C.constant(i);
+    return weights;
+}
+
+/**
+ * @return true if the terms can exceed K, for MDD considering that at most one term of each group is true
+ */
+bool falsifiable(PBEncodingType type, const vector<int>& weights, const vector<int>& groups, int K) {
+    long sum = 0;
+    if (type != PBEncodingType::MDD) for (int w : weights) sum += w;
+    else {
+        for (int g = 0; g + 1 < (int)groups.size(); g++)
+            sum += *max_element(weights.begin() + groups[g], weights.begin() + groups[g + 1]);
+    }
+    return sum > K;
+}
+
+/**
+ * @return true if the encoding can be used for constraints with these constants
+ */
+bool supports(PBEncodingType type, const vector<int>& weights) {
+    if (type != PBEncodingType::TOTALIZER && type != PBEncodingType::SORTING_NETWORK) return true;
+    return all_of(weights.begin(), weights.end(), [&](int w) { return w == weights[0]; });
+}
+
+double weight(PBEncodingType type) {
+    if (type == PBEncodingType::BDD || type == PBEncodingType::MDD) return PB_DD_WEIGHT;
+    if (type == PBEncodingType::ADDER) return PB_ADDER_WEIGHT;
+    return 1.0;
+}
+}
+
+PBEncodingSize PBEncoder::estimate(PBEncodingType type, const PBConstr& C, long limit) {
+    vector<int> weights = constants(C);
+    vector<int> groups = MDD::groups(C);
+    PBEncodingSize size;
+    if (!falsifiable(type, weights, groups, C.K)) return size; // No clauses are needed
+    if (!supports(type, weights)) {
+        size.applicable = false;
+        return size;
+    }
+    if (type == PBEncodingType::BDD) return estimateBDD(weights, C.K, limit);
+    if (type == PBEncodingType::MDD) return estimateMDD(weights, groups, C.K, limit);
+    ClauseBuilder b(nullptr, C.nTerms(), limit);
+    build(type, weights, C.K, b);
+    return b.result();
+}
+
+PBEncodingType PBEncoder::choose(const PBConstr& C) {
+    PBEncodingType best = PBEncodingType::BDD;
+    PBEncodingSize size = estimate(best, C);
+    double bestCost = weight(best) * (double)(size.clauses + size.vars);
+    for (int t = 0; t < PB_N_ENCODINGS; t++) {
+        auto type = (PBEncodingType)t;
+        if (type == PBEncodingType::BDD) continue;
+        size = estimate(type, C, (long)(bestCost / weight(type)));
+        double cost = weight(type) * (double)(size.clauses + size.vars);
+        if (size.applicable && cost < bestCost) {
+            best = type;
+            bestCost = cost;
+        }
+    }
+    return best;
+}
+
+PBEncoding PBEncoder::encode(PBEncodingType type, const PBConstr& C, PBWorkspace& workspace) {
+    if (type == PBEncodingType::AUTO) type = choose(C);
+    vector<int> weights = constants(C);
+    vector<int> groups = MDD::groups(C);
+    if (!supports(type, weights)) type = PBEncodingType::BDD;
+    PBEncoding out;
+    out.type = type;
+    out.nTerms = C.nTerms();
+    if (!falsifiable(type, weights, groups, C.K)) return out;
+    if (type == PBEncodingType::BDD) encodeBDD(C, workspace, out);
+    else if (type == PBEncodingType::MDD) encodeMDD(C, groups, workspace, out);
+    else {
+        ClauseBuilder b(&out, C.nTerms(), INT64_MAX);
+        build(type, weights, C.K, b);
+    }
+    return out;
+}
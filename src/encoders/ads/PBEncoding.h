@@ -0,0 +1,136 @@
+/************************************************************************************[PBEncoding.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#ifndef RCPSPT_EXACT_PBENCODING_H
+#define RCPSPT_EXACT_PBENCODING_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+#include "Arena.h"
+#include "BDD.h"
+#include "LSet.h"
+#include "MDD.h"
+#include "PBConstr.h"
+
+#define PB_N_ENCODINGS 6 // Number of PB encodings (excluding AUTO)
+#define PB_DD_WEIGHT 0.5 // Weight of the estimated sizes of BDD-1 and MDD, the estimates are upper bounds on the size of the diagrams
+#define PB_ADDER_WEIGHT 4.0 // Weight of the estimated size of the adder encoding, which propagates less than the others
+
+using namespace std;
+
+namespace RcpsptExact {
+
+/**
+ * Encodings of a PB constraint into clauses. The first PB_N_ENCODINGS values can be used as index.
+ */
+enum class PBEncodingType {
+    BDD, // BDD-1 based on the ROBDD of the constraint, see Example 24 in the paper by I. Abío et al. (2012)
+    MDD, // Like BDD-1, but based on an MDD with one layer per activity, of which at most one start variable is true
+    TOTALIZER, // Totalizer by O. Bailleux and Y. Boufkhad (2003), only for constraints in which all constants are equal
+    SORTING_NETWORK, // Odd-even merge sorting network by N. Eén and N. Sörensson (2006), only if all constants are equal
+    GENERALIZED_TOTALIZER, // Generalized totalizer by S. Joshi, R. Martins and V. Manquinho (2015)
+    ADDER, // Network of binary adders and a comparator by N. Eén and N. Sörensson (2006)
+    AUTO // Chosen for each constraint, based on the estimated sizes of the encodings (see PBEncoder::choose)
+};
+
+/**
+ * Clauses of the encoding of a PB constraint. Variables are numbered from 1: variable v <= nTerms is the variable of
+ * term v-1 of the constraint, the others are auxiliary variables. Literals are variables, negated if negative.
+ * The encoding only depends on the constants of the constraint, K, and which (consecutive) terms belong to the same
+ * activity; not on the variables themselves.
+ */
+struct PBEncoding {
+    PBEncodingType type = PBEncodingType::BDD;
+    int nTerms = 0;
+    int nAux = 0; // Number of auxiliary variables
+    int nClauses = 0;
+    vector<int> lits; // Literals of all clauses, each clause is terminated by a 0
+
+    /**
+     * @return the variable of a new auxiliary variable
+     */
+    int newAux() { return nTerms + 1 + nAux++; }
+
+    void addClause(initializer_list<int> clause) { addClause(clause.begin(), clause.end()); }
+
+    template<typename It>
+    void addClause(It first, It last) {
+        lits.insert(lits.end(), first, last);
+        lits.push_back(0);
+        nClauses++;
+    }
+};
+
+/**
+ * Estimated size of the encoding of a PB constraint.
+ */
+struct PBEncodingSize {
+    long clauses = 0;
+    long vars = 0; // Number of auxiliary variables
+    bool applicable = true; // False if the encoding cannot be used for the constraint, or exceeds the given limit
+};
+
+/**
+ * Memory that is reused for encoding PB constraints one after another (on one thread).
+ */
+struct PBWorkspace {
+    Arena arena; // Nodes of the decision diagrams
+    vector<LSet<BDD>> bddLayers; // Layers for BDD::BDDConstruction
+    vector<LSet<MDD>> mddLayers; // Layers for MDD::MDDConstruction
+};
+
+/**
+ * Encodes PB constraints (sum of the terms <= K, with positive constants) into clauses.
+ * Terms with the same activity (var.first) are the start variables of that activity, of which at most one is true in
+ * any solution that is decoded (the first start time is used). The MDD encoding relies on this.
+ */
+class PBEncoder {
+public:
+    /**
+     * Estimates the size of an encoding of a constraint, without constructing it.
+     * The estimate is exact for all encodings except BDD-1, for which it is an upper bound.
+     *
+     * @param type the encoding (not AUTO)
+     * @param C the constraint
+     * @param limit the estimate stops once it exceeds this number of clauses (the result is then not applicable)
+     */
+    static PBEncodingSize estimate(PBEncodingType type, const PBConstr& C, long limit = INT64_MAX);
+
+    /**
+     * Chooses the encoding for a constraint with the smallest estimated number of clauses plus variables.
+     * The estimates of BDD-1 and MDD are weighted by PB_DD_WEIGHT and that of the adder encoding by PB_ADDER_WEIGHT.
+     */
+    static PBEncodingType choose(const PBConstr& C);
+
+    /**
+     * Encodes a constraint. A constraint that cannot be falsified results in an encoding without clauses.
+     *
+     * @param type the encoding, if it is AUTO then it is chosen by choose()
+     * @param workspace memory for constructing decision diagrams
+     */
+    static PBEncoding encode(PBEncodingType type, const PBConstr& C, PBWorkspace& workspace);
+};
+}
+
+#endif //RCPSPT_EXACT_PBENCODING_H
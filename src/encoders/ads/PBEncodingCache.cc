@@ -0,0 +1,81 @@
+/******************************************************************************[PBEncodingCache.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+
+#include "PBEncodingCache.h"
+#include "../../utils/ParallelFor.h"
+
+using namespace RcpsptExact;
+
+size_t PBEncodingCache::KeyHash::operator()(const vector<int>& key) const {
+    size_t hash = key.size();
+    for (int value : key) hash ^= (size_t)value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+vector<const PBEncoding*> PBEncodingCache::getAll(const PBConstrList& constrs, PBEncodingType type, int nthreads) {
+    // Look up all constraints, and collect one representative for each encoding that is still missing
+    int n = constrs.size();
+    vector<int> missing; // For each missing encoding: index of the first constraint that needs it
+    vector<int> missingIndex(n, -1); // For each constraint: index in missing (-1 if its encoding is in the cache)
+    unordered_map<vector<int>, int, KeyHash> missingKeys;
+    vector<vector<int>> keys(n);
+    vector<const PBEncoding*> result(n, nullptr);
+    for (int c = 0; c < n; c++) {
+        PBConstr C = constrs[c];
+        vector<int>& key = keys[c];
+        key.reserve(C.nTerms() + 1);
+        key.push_back(C.K);
+        for (int i = 0; i < C.nTerms(); i++) { // Negated for the first term of each activity
+            key.push_back(i > 0 && C.var(i).first == C.var(i - 1).first ? C.constant(i) : -C.constant(i));
+        }
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            result[c] = &it->second;
+            nhits++;
+            continue;
+        }
+        auto inserted = missingKeys.emplace(key, (int)missing.size());
+        if (inserted.second) missing.push_back(c);
+        else nhits++;
+        missingIndex[c] = inserted.first->second;
+    }
+
+    // Construct the missing encodings, distributed dynamically over the worker threads
+    vector<PBEncoding> built(missing.size());
+    nthreads = max(1, min(nthreads, (int)missing.size()));
+    vector<size_t> peaks(nthreads, 0);
+    atomic<int> next(0);
+    parallelFor(nthreads, nthreads, [&](int w) {
+        PBWorkspace workspace;
+        for (int m = next++; m < (int)missing.size(); m = next++) built[m] = PBEncoder::encode(type, constrs[missing[m]], workspace);
+        peaks[w] = workspace.arena.highWater();
+    });
+    for (size_t workerPeak : peaks) peak = max(peak, workerPeak);
+
+    vector<const PBEncoding*> cached(missing.size());
+    for (int m = 0; m < (int)missing.size(); m++) cached[m] = &cache.emplace(move(keys[missing[m]]), move(built[m])).first->second;
+    for (int c = 0; c < n; c++) if (missingIndex[c] >= 0) result[c] = cached[missingIndex[c]];
+    return result;
+}
@@ -0,0 +1,76 @@
+/*******************************************************************************[PBEncodingCache.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#ifndef RCPSPT_EXACT_PBENCODINGCACHE_H
+#define RCPSPT_EXACT_PBENCODINGCACHE_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "PBConstr.h"
+#include "PBEncoding.h"
+
+using namespace std;
+
+namespace RcpsptExact {
+
+/**
+ * Cache of the encodings of the PB constraints of one encoding, keyed by the constants of a constraint and its K (and
+ * which terms belong to the same activity).
+ * Resource constraints of neighbouring time steps often have the same constants (with shifted variables) and the same
+ * capacity, so only the first of them needs to construct its encoding; the others only emit clauses for it.
+ */
+class PBEncodingCache {
+public:
+    /**
+     * Gets the encodings of a list of PB constraints. The encodings that are not in the cache yet are constructed in
+     * parallel, each worker thread using its own arena and layers. The result does not depend on the number of threads.
+     *
+     * @param constrs the constraints
+     * @param type the encoding to use (AUTO: chosen for each constraint, see PBEncoder::choose)
+     * @param nthreads number of worker threads
+     * @return the encoding for each constraint, which stays valid as long as the cache exists
+     */
+    vector<const PBEncoding*> getAll(const PBConstrList& constrs, PBEncodingType type, int nthreads);
+
+    /**
+     * @return the number of constraints for which the encoding was found in the cache
+     */
+    int hits() const { return nhits; }
+
+    /**
+     * @return the peak memory in bytes used for constructing the ROBDD of a single constraint
+     */
+    size_t highWater() const { return peak; }
+
+private:
+    struct KeyHash {
+        size_t operator()(const vector<int>& key) const;
+    };
+
+    unordered_map<vector<int>, PBEncoding, KeyHash> cache; // Key: K followed by the constants of the constraint (see getAll)
+    int nhits = 0;
+    size_t peak = 0;
+};
+}
+
+#endif //RCPSPT_EXACT_PBENCODINGCACHE_H
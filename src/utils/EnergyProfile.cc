@@ -0,0 +1,54 @@
+/********************************************************************************[EnergyProfile.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#include <algorithm>
+
+#include "EnergyProfile.h"
+
+using namespace RcpsptExact;
+
+EnergyProfile::EnergyProfile(const Problem& problem)
+        : nresources(problem.nresources),
+          nwords((problem.njobs + 63) / 64),
+          energies(problem.njobs * problem.nresources, 0),
+          maxCapacities(problem.nresources, 0) {
+    for (int i = 0; i < problem.njobs; i++) {
+        for (int k = 0; k < nresources; k++) {
+            const int* requests = problem.requests(i, k);
+            for (int t = 0; t < problem.durations[i]; t++) energies[i * nresources + k] += requests[t];
+        }
+    }
+    for (int k = 0; k < nresources; k++)
+        maxCapacities[k] = *max_element(problem.capacities(k), problem.capacities(k) + problem.horizon);
+}
+
+void EnergyProfile::intersectionEnergy(const uint64_t* setA, const uint64_t* setB, int* sums) const {
+    fill(sums, sums + nresources, 0);
+    for (int w = 0; w < nwords; w++) {
+        uint64_t both = setA[w] & setB[w];
+        while (both != 0) {
+            const int* jobEnergies = &energies[(w * 64 + __builtin_ctzll(both)) * nresources];
+            for (int k = 0; k < nresources; k++) sums[k] += jobEnergies[k];
+            both &= both - 1;
+        }
+    }
+}
@@ -0,0 +1,78 @@
+/*********************************************************************************[EnergyProfile.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#ifndef RCPSPT_EXACT_ENERGYPROFILE_H
+#define RCPSPT_EXACT_ENERGYPROFILE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "../Problem.h"
+
+using namespace std;
+
+namespace RcpsptExact {
+
+/**
+ * Energies of an instance for energetic reasoning: the total request of each job for each resource over its duration,
+ * and the maximum capacity of each resource over the horizon. The energies are computed once, so that the energy of
+ * a set of jobs can be summed without rescanning their requests.
+ *
+ * Sets of jobs are given as bitsets over the jobs (bit a of word a/64 is set if job a is in the set), of words() words.
+ */
+class EnergyProfile {
+public:
+    explicit EnergyProfile(const Problem& problem);
+
+    /**
+     * @return the number of 64-bit words in a bitset over the jobs
+     */
+    int words() const { return nwords; }
+
+    /**
+     * @return the sum of the requests of the job for resource k over its duration
+     */
+    int energy(int job, int k) const { return energies[job * nresources + k]; }
+
+    /**
+     * @return the maximum capacity of resource k over the horizon
+     */
+    int maxCapacity(int k) const { return maxCapacities[k]; }
+
+    /**
+     * Sums the energies of the jobs that are in both sets, for each resource.
+     *
+     * @param setA first set of jobs
+     * @param setB second set of jobs
+     * @param sums where to store the energy of the intersection for each resource (nresources values)
+     */
+    void intersectionEnergy(const uint64_t* setA, const uint64_t* setB, int* sums) const;
+
+private:
+    int nresources;
+    int nwords;
+    vector<int> energies; // Energy for each resource, per job
+    vector<int> maxCapacities; // Maximum capacity over the horizon for each resource
+};
+}
+
+#endif //RCPSPT_EXACT_ENERGYPROFILE_H
@@ -0,0 +1,70 @@
+/*****************************************************************************[FeasibilityIndex.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#include <algorithm>
+
+#include "FeasibilityIndex.h"
+
+using namespace RcpsptExact;
+
+FeasibilityIndex::FeasibilityIndex(const Problem& problem)
+        : horizon(problem.horizon),
+          nwords(problem.horizon / 64 + 2),
+          durations(problem.durations),
+          starts((size_t)problem.njobs * nwords) {
+    // Threshold bitsets: bit t of thresholds[k][v] is set if the capacity of resource k at time t is at least v.
+    // They are only built for request values that occur, and end with a zero word so shifted reads stay in range
+    vector<vector<vector<uint64_t>>> thresholds(problem.nresources);
+
+    for (int i = 0; i < problem.njobs; i++) {
+        int duration = problem.durations[i];
+        uint64_t* bits = &starts[(size_t)i * nwords];
+        // Start with all start times s for which the job ends within the horizon (s <= horizon-duration)
+        if (duration > horizon) continue;
+        int last = horizon - duration;
+        for (int w = 0; w <= last / 64; w++) bits[w] = ~(uint64_t)0;
+        if ((last + 1) % 64 != 0) bits[last / 64] = ((uint64_t)1 << ((last + 1) % 64)) - 1;
+
+        for (int k = 0; k < problem.nresources; k++) {
+            const int* requests = problem.requests(i, k);
+            for (int t = 0; t < duration; t++) {
+                int v = requests[t];
+                if (v <= 0) continue; // Always satisfied (capacities are not negative)
+                if ((int)thresholds[k].size() <= v) thresholds[k].resize(v + 1);
+                vector<uint64_t>& threshold = thresholds[k][v];
+                if (threshold.empty()) {
+                    threshold.assign(nwords + 1, 0);
+                    const int* capacities = problem.capacities(k);
+                    for (int u = 0; u < horizon; u++)
+                        if (capacities[u] >= v) threshold[u / 64] |= (uint64_t)1 << (u % 64);
+                }
+                // Start s is only feasible if bit s+t of the threshold is set
+                int offset = t / 64, shift = t % 64;
+                for (int w = 0; w <= last / 64; w++) {
+                    uint64_t shifted = threshold[w + offset] >> shift;
+                    if (shift != 0) shifted |= threshold[w + offset + 1] << (64 - shift);
+                    bits[w] &= shifted;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,91 @@
+/******************************************************************************[FeasibilityIndex.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#ifndef RCPSPT_EXACT_FEASIBILITYINDEX_H
+#define RCPSPT_EXACT_FEASIBILITYINDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "../Problem.h"
+
+using namespace std;
+
+namespace RcpsptExact {
+
+/**
+ * Index of the start times at which each job fits within the (time-dependent) resource capacities, when it is the only
+ * job being scheduled. Used to find the next/previous feasible start time of a job without shifting the candidate start
+ * one step at a time and rechecking all resources over the whole duration.
+ *
+ * The feasible start times of a job are stored as a bitset over [0, horizon]. It is built by combining, for every
+ * request of the job, a shifted bitset of the time steps at which the capacity is at least that request. These
+ * threshold bitsets are shared by all jobs, so building the index costs O(njobs*nresources*duration*horizon/64).
+ * Queries scan the bitset a word (64 time steps) at a time.
+ */
+class FeasibilityIndex {
+public:
+    explicit FeasibilityIndex(const Problem& problem);
+
+    /**
+     * @return the smallest feasible start time of the job that is at least s, or -1 if there is none
+     */
+    inline int nextStart(int job, int s) const {
+        int last = horizon - durations[job];
+        s = max(s, 0);
+        if (s > last) return -1;
+        const uint64_t* bits = &starts[(size_t)job * nwords];
+        int w = s / 64;
+        uint64_t word = bits[w] & (~(uint64_t)0 << (s % 64));
+        while (word == 0) {
+            if (++w > last / 64) return -1;
+            word = bits[w];
+        }
+        return w * 64 + __builtin_ctzll(word);
+    }
+
+    /**
+     * @return the largest feasible start time of the job that is at most s, or -1 if there is none
+     */
+    inline int prevStart(int job, int s) const {
+        s = min(s, horizon - durations[job]);
+        if (s < 0) return -1;
+        const uint64_t* bits = &starts[(size_t)job * nwords];
+        int w = s / 64;
+        uint64_t word = bits[w] & (~(uint64_t)0 >> (63 - s % 64));
+        while (word == 0) {
+            if (--w < 0) return -1;
+            word = bits[w];
+        }
+        return w * 64 + 63 - __builtin_clzll(word);
+    }
+
+private:
+    int horizon;
+    int nwords; // Number of 64-bit words per bitset, covering time steps [0, horizon] plus padding
+    vector<int> durations;
+    vector<uint64_t> starts; // Bitset of feasible start times for each job (nwords words per job)
+};
+}
+
+#endif //RCPSPT_EXACT_FEASIBILITYINDEX_H
@@ -23,10 +23,16 @@ SOFTWARE.
 #ifndef RCPSPT_EXACT_HEURISTICSOLVER_H
 #define RCPSPT_EXACT_HEURISTICSOLVER_H
 
-#include <queue>
+#include <algorithm>
 #include <random>
 
+#include "FeasibilityIndex.h"
+#include "ParallelFor.h"
+#include "ResourceKernel.h"
+#include "TemporalAnalysis.h"
+
 #define TOURN_FACTOR 0.5
+#define PASS_FACTOR 50 // Number of passes per (non-dummy) job
 #define OMEGA1 0.4
 #define OMEGA2 0.6
 
@@ -34,75 +40,148 @@ using namespace std;
 
 namespace RcpsptExact {
 
+/**
+ * Serial schedule generation scheme (SGS) for the passes of the tournament heuristic, which schedules the jobs one by one
+ * (as early as possible) in an order that is determined by tournaments between randomly selected eligible jobs.
+ * The eligible jobs are maintained incrementally (using counters of unscheduled predecessors), and all buffers are
+ * allocated once, so that the kernel can be reused for many passes without allocating memory.
+ */
+class SgsKernel {
+public:
+    /**
+     * @param problem problem instance to consider
+     * @param priorities priority value for each job
+     * @param index feasible start times of each job considering the full resource capacities
+     */
+    SgsKernel(const Problem& problem, const vector<double>& priorities, const FeasibilityIndex& index)
+            : problem(problem), priorities(priorities), index(index), available(problem.nresources * problem.horizon),
+              schedule(problem.njobs), remainingPredecessors(problem.njobs) {
+        eligible.reserve(problem.njobs);
+    }
+
+    /**
+     * Runs a single pass of the tournament heuristic.
+     *
+     * @param pass index of the pass, which determines the random seed
+     * @return true if all jobs could be scheduled within the horizon
+     */
+    bool run(int pass) {
+        seed_seq seeds{42, pass}; // Fixed seed for deterministic bounds to compare different encodings/solvers
+        default_random_engine eng(seeds);
+        uniform_real_distribution<double> distribution(0, 1);
+
+        for (int i = 1; i < problem.njobs; i++) {
+            schedule[i] = -1;
+            remainingPredecessors[i] = (int)problem.predecessors[i].size();
+        }
+        // Initialize remaining resource availabilities
+        copy(problem.capacities(0), problem.capacities(0) + problem.nresources * problem.horizon, available.begin());
+
+        // Schedule the starting dummy activity
+        eligible.clear();
+        schedule[0] = 0;
+        release(0);
+
+        // Schedule all remaining jobs
+        for (int i = 1; i < problem.njobs; i++) {
+            // Randomly select a fraction of the eligible activities (with replacement),
+            // and keep the one with the best priority value
+            int Z = max((int)(TOURN_FACTOR * (int)eligible.size()), 2);
+            int winner = -1, winnerIndex = -1;
+            double bestPriority = -MAXFLOAT/2.0;
+            for (int j = 0; j < Z; j++) {
+                int choice = (int)(distribution(eng) * (int)eligible.size());
+                if (priorities[eligible[choice]] >= bestPriority) {
+                    bestPriority = priorities[eligible[choice]];
+                    winner = eligible[choice];
+                    winnerIndex = choice;
+                }
+            }
+            // Schedule it as early as possible
+            int finish = -1;
+            for (int predecessor : problem.predecessors[winner]) {
+                int newFinish = schedule[predecessor] + problem.durations[winner];
+                if (newFinish > finish) finish = newFinish;
+            }
+            int duration = problem.durations[winner];
+            // Only start times at which the job fits within the full capacities can fit within the remaining ones.
+            // From there, a block of consecutive candidate start times is checked at once
+            int start = index.nextStart(winner, finish - duration);
+            while (start >= 0) {
+                int nstarts = min(ResourceKernel::MAX_STARTS, problem.horizon - duration - start + 1);
+                uint32_t all = nstarts == 32 ? ~(uint32_t)0 : ((uint32_t)1 << nstarts) - 1;
+                uint32_t violated = 0;
+                for (int k = 0; violated != all && k < problem.nresources; k++) {
+                    violated |= ResourceKernel::violationMask(problem.requests(winner, k), &available[k * problem.horizon + start],
+                                                              duration, nstarts);
+                }
+                if (violated != all) {
+                    start += __builtin_ctz(~violated);
+                    break;
+                }
+                start = index.nextStart(winner, start + nstarts);
+            }
+            if (start < 0) return false; // Skip the rest of this pass
+            finish = start + duration;
+            schedule[winner] = finish;
+            // Update remaining resource availabilities
+            for (int k = 0; k < problem.nresources; k++) {
+                const int* requests = problem.requests(winner, k);
+                int* remaining = &available[k * problem.horizon + finish - duration];
+                for (int t = 0; t < duration; t++) remaining[t] -= requests[t];
+            }
+            eligible.erase(eligible.begin() + winnerIndex);
+            release(winner);
+        }
+        return true;
+    }
+
+    /**
+     * @return finish(!) time for each job after the last pass (-1 for jobs that could not be scheduled)
+     */
+    const vector<int>& finishTimes() const { return schedule; }
+
+private:
+    const Problem& problem;
+    const vector<double>& priorities;
+    const FeasibilityIndex& index;
+    vector<int> available; // Remaining capacity for each time step, per resource (same layout as Problem)
+    vector<int> schedule; // Finish(!) time for each job
+    vector<int> remainingPredecessors; // Number of unscheduled predecessors for each job
+    vector<int> eligible; // Unscheduled jobs of which all predecessors are scheduled, in ascending order
+
+    /**
+     * Makes the successors of a job that has just been scheduled eligible, if they have no other unscheduled predecessors.
+     * The eligible jobs are kept in ascending order, so that tournaments do not depend on the order of scheduling.
+     */
+    void release(int job) {
+        for (int successor : problem.successors[job]) {
+            if (--remainingPredecessors[successor] == 0)
+                eligible.insert(lower_bound(eligible.begin(), eligible.end(), successor), successor);
+        }
+    }
+};
+
 /**
  * Tournament heuristic using a priority rule, used for calculating initial lower and upper bounds on the makespan.
  *
  * @param problem problem instance to consider
  * @param solution vector in which to store final schedule (empty if infeasible).
  * Schedule may be invalid if no solution with makespan<horizon could be found
+ * @param nthreads number of worker threads for running the passes (does not influence the result)
  * @return pair of integers (lower_bound, upper_bound)
  */
-pair<int, int> calcBoundsPriorityRule(const Problem& problem, vector<int>& solution) {
+pair<int, int> calcBoundsPriorityRule(const Problem& problem, vector<int>& solution, int nthreads = defaultThreadCount()) {
     // This function is based on the tournament heuristic that is described by Hartmann (2013) (reference in README.md)
 
     solution.clear();
-    queue<int> q; // Use a queue for breadth-first traversal of the precedence graph
-    vector<int> ef(problem.njobs, 0); // Earliest feasible finish time for each job
-    q.push(0);
-    while(!q.empty()) {
-        int job = q.front();
-        q.pop();
-        int duration = problem.durations[job];
-        // Move finish until it is feasible considering resource constraints
-        bool feasibleFinal = false;
-        while (!feasibleFinal) {
-            bool feasible = true;
-            for (int k = 0; feasible && k < problem.nresources; k++) {
-                for (int t = duration - 1; feasible && t >= 0; t--) {
-                    if (problem.requests[job][k][t] > problem.capacities[k][ef[job] - duration + t]) {
-                        feasible = false;
-                        ef[job]++;
-                    }
-                }
-            }
-            if (feasible) feasibleFinal = true;
-            if (ef[job] > problem.horizon) return {0, problem.horizon};
-        }
-        // Update finish times, and enqueue successors
-        for (int successor : problem.successors[job]) {
-            int f = ef[job] + problem.durations[successor];
-            if (f > ef[successor]) ef[successor] = f; // Use maximum values, because we are interested in critical paths
-            q.push(successor); // Enqueue successor
-        }
-    }
-    vector<int> ls(problem.njobs, problem.horizon); // Latest feasible start time for each job
-    q.push(problem.njobs - 1);
-    while (!q.empty()) {
-        int job = q.front();
-        q.pop();
-        int duration = problem.durations[job];
-        // Move start until it is feasible considering resource constraints
-        bool feasibleFinal = false;
-        while (!feasibleFinal) {
-            bool feasible = true;
-            for (int k = 0; feasible && k < problem.nresources; k++) {
-                for (int t = 0; feasible && t < duration; t++) {
-                    if (problem.requests[job][k][t] > problem.capacities[k][ls[job] + t]) {
-                        feasible = false;
-                        ls[job]--;
-                    }
-                }
-            }
-            if (feasible) feasibleFinal = true;
-            if (ls[job] < 0) return {ef.back(), problem.horizon};
-        }
-        // Update start times, and enqueue predecessors
-        for (int predecessor : problem.predecessors[job]) {
-            int s = ls[job] - problem.durations[predecessor];
-            if (s < ls[predecessor]) ls[predecessor] = s; // Use minimum values for determining critical paths
-            q.push(predecessor); // Enqueue predecessor
-        }
-    }
+    // Time windows considering only the precedences and resource capacities (shared with the encoders of this instance)
+    const TemporalAnalysis& temporal = problem.temporal();
+    const FeasibilityIndex& index = temporal.index();
+    shared_ptr<const TimeWindows> windows = temporal.windows(problem.horizon);
+    if (!windows->feasible) return {windows->lowerBound, problem.horizon};
+    const vector<int>& ef = windows->EC; // Earliest feasible finish time for each job
+    const vector<int>& ls = windows->LS; // Latest feasible start time for each job
 
     // Check if any time window is too small: lf[i]-es[i]<durations[i]
     // using the definition from Hartmann (2013) (reference in README.md)
@@ -114,22 +193,22 @@ pair<int, int> calcBoundsPriorityRule(const Problem& problem, vector<int>& solut
 
     // Calculate extended resource utilization values, using the definition from Hartmann (2013) (reference in README.md)
     vector<double> ru(problem.njobs);
-    q.push(problem.njobs - 1); // Enqueue sink job
-    while (!q.empty()) {
-        int job = q.front();
-        q.pop();
+    // Reverse topological order, so the values of all successors of a job are final when it is reached
+    const vector<int>& order = temporal.topologicalOrder();
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        int job = *it;
         int duration = problem.durations[job];
         int demand = 0, availability = 0;
         for (int k = 0; k < problem.nresources; k++) {
-            for (int t = 0; t < duration; t++) demand += problem.requests[job][k][t];
-            for (int t = ef[job] - duration; t < ls[job] + duration; t++) availability += problem.capacities[k][t]; // t in RTW(job)
+            const int* requests = problem.requests(job, k);
+            const int* capacities = problem.capacities(k);
+            for (int t = 0; t < duration; t++) demand += requests[t];
+            for (int t = ef[job] - duration; t < ls[job] + duration; t++) availability += capacities[t]; // t in RTW(job)
         }
         ru[job] = OMEGA1 * (((double) problem.successors[job].size() / (double) problem.nresources) *
                             ((double) demand / (double) availability));
         for (int successor : problem.successors[job]) ru[job] += OMEGA2 * ru[successor];
         if (isnan(ru[job]) || ru[job] < 0.0) ru[job] = 0.0; // Prevent errors from strange values here
-        // Enqueue predecessors
-        for (int predecessor : problem.predecessors[job]) q.push(predecessor);
     }
 
     // Calculate the CPRU (critical path and resource utilization) priority value for each activity, using the definition from Hartmann (2013) (reference in README.md)
@@ -139,82 +218,38 @@ pair<int, int> calcBoundsPriorityRule(const Problem& problem, vector<int>& solut
         cpru[job] = cp * ru[job];
     }
 
-    //random_device rd;
-    default_random_engine eng(42); // Set seed for deterministic bounds to compare different encodings/solvers
-    uniform_real_distribution<double> distribution(0, 1);
     // Run a number of passes ('tournaments'), as described by Hartmann (2013) (reference in README.md)
-    vector<vector<int>> available(problem.nresources);
-    vector<int> schedule(problem.njobs); // Finish(!) time for each process
-    int bestMakespan = INT32_MAX/2;
-    for (int pass = 0; pass < (problem.njobs - 2) * 5; pass++) { // Number of passes scales with number of jobs (njobs multiplied by a magic number 5, in this case)
-        for (int i = 1; i < problem.njobs; i++) schedule[i] = -1;
-        // Initialize remaining resource availabilities
-        for (int k = 0; k < problem.nresources; k++)
-            available[k] = problem.capacities[k];
-
-        // Schedule the starting dummy activity
-        schedule[0] = 0;
-
-        // Schedule all remaining jobs
-        for (int i = 1; i < problem.njobs; i++) {
-            // Randomly select a fraction of the eligible activities (with replacement)
-            vector<int> eligible;
-            for (int j = 1; j < problem.njobs; j++) {
-                if (schedule[j] >= 0) continue;
-                bool predecessorsScheduled = true;
-                for (int predecessor : problem.predecessors[j])
-                    if (schedule[predecessor] < 0) predecessorsScheduled = false;
-                if (predecessorsScheduled) eligible.push_back(j);
-            }
-            int Z = max((int)(TOURN_FACTOR * (int)eligible.size()), 2);
-            vector<int> selected;
-            for (int j = 0; j < Z; j++) {
-                int choice = (int)(distribution(eng) * (int)eligible.size());
-                selected.push_back(eligible[choice]);
-            }
-            // Select the activity with the best priority value
-            int winner = -1;
-            double bestPriority = -MAXFLOAT/2.0;
-            for (int sjob : selected) {
-                if (cpru[sjob] >= bestPriority) {
-                    bestPriority = cpru[sjob];
-                    winner = sjob;
-                }
-            }
-            // Schedule it as early as possible
-            int finish = -1;
-            for (int predecessor : problem.predecessors[winner]) {
-                int newFinish = schedule[predecessor] + problem.durations[winner];
-                if (newFinish > finish) finish = newFinish;
-            }
-            int duration = problem.durations[winner];
-            bool feasibleFinal = false;
-            while (!feasibleFinal) {
-                bool feasible = true;
-                for (int k = 0; feasible && k < problem.nresources; k++) {
-                    for (int t = duration - 1; feasible && t >= 0; t--) {
-                        if (problem.requests[winner][k][t] > available[k][finish - duration + t]) {
-                            feasible = false;
-                            finish++;
-                        }
-                    }
-                }
-                if (feasible) feasibleFinal = true;
-                if (finish > problem.horizon) {
-                    feasibleFinal = false;
-                    break;
-                }
-            }
-            if (!feasibleFinal) break; // Skip the rest of this pass
-            schedule[winner] = finish;
-            // Update remaining resource availabilities
-            for (int k = 0; k < problem.nresources; k++) {
-                for (int t = 0; t < duration; t++)
-                    available[k][finish - duration + t] -= problem.requests[winner][k][t];
+    // Passes are independent and distributed over worker threads, each pass has its own seed so the result does not
+    // depend on the number of threads. The best schedule is the one with the smallest makespan (earliest pass on ties)
+    int npasses = (problem.njobs - 2) * PASS_FACTOR;
+    nthreads = max(1, min(nthreads, npasses));
+    vector<int> bestMakespans(nthreads, INT32_MAX/2), bestPasses(nthreads, -1);
+    vector<vector<int>> bestSchedules(nthreads);
+    parallelFor(nthreads, nthreads, [&](int w) {
+        SgsKernel kernel(problem, cpru, index);
+        for (int pass = w; pass < npasses; pass += nthreads) {
+            if (kernel.run(pass) && kernel.finishTimes().back() < bestMakespans[w]) {
+                bestMakespans[w] = kernel.finishTimes().back();
+                bestPasses[w] = pass;
+                bestSchedules[w] = kernel.finishTimes();
             }
         }
-        if (schedule.back() >= 0 && schedule.back() < bestMakespan) bestMakespan = schedule.back();
+    });
+    int best = -1;
+    for (int w = 0; w < nthreads; w++) {
+        if (bestPasses[w] < 0) continue;
+        if (best < 0 || bestMakespans[w] < bestMakespans[best] ||
+            (bestMakespans[w] == bestMakespans[best] && bestPasses[w] < bestPasses[best])) best = w;
     }
+    int bestMakespan = best >= 0 ? bestMakespans[best] : INT32_MAX/2;
+    vector<int> schedule(problem.njobs, 0);
+    if (best >= 0) schedule = bestSchedules[best];
+    else if (npasses > 0) { // No pass found a schedule within the horizon, output the (incomplete) schedule of the last pass
+        SgsKernel kernel(problem, cpru, index);
+        kernel.run(npasses - 1);
+        schedule = kernel.finishTimes();
+    }
+
     // Output the final schedule (may be invalid)
     for (int i = 0; i < problem.njobs; i++) solution.push_back(schedule[i] - problem.durations[i]);
     // For the lower bound we use earliest start of end dummy activity (start is same as finish for this activity)
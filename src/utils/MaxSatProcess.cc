@@ -0,0 +1,144 @@
+/********************************************************************************[MaxSatProcess.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "MaxSatProcess.h"
+
+using namespace RcpsptExact;
+
+MaxSatProcess::MaxSatProcess(const string& command) {
+    int toSolver[2], fromSolver[2];
+    if (pipe(toSolver) < 0) {
+        std::cerr << "Cannot create pipe: " << strerror(errno) << std::endl;
+        return;
+    }
+    if (pipe(fromSolver) < 0) {
+        std::cerr << "Cannot create pipe: " << strerror(errno) << std::endl;
+        close(toSolver[0]);
+        close(toSolver[1]);
+        return;
+    }
+
+    pid = fork();
+    if (pid < 0) {
+        std::cerr << "Cannot start solver: " << strerror(errno) << std::endl;
+        for (int fd : {toSolver[0], toSolver[1], fromSolver[0], fromSolver[1]}) close(fd);
+        return;
+    }
+    if (pid == 0) { // Solver process
+        dup2(toSolver[0], STDIN_FILENO);
+        dup2(fromSolver[1], STDOUT_FILENO);
+        for (int fd : {toSolver[0], toSolver[1], fromSolver[0], fromSolver[1]}) close(fd);
+        execl("/bin/sh", "sh", "-c", command.c_str(), (char*)nullptr);
+        _exit(127);
+    }
+
+    close(toSolver[0]);
+    close(fromSolver[1]);
+    inFd = toSolver[1];
+    outFd = fromSolver[0];
+    reader = thread(&MaxSatProcess::readOutput, this);
+}
+
+MaxSatProcess::~MaxSatProcess() {
+    if (pid > 0) finish();
+}
+
+bool MaxSatProcess::finish() {
+    if (inFd >= 0) {
+        close(inFd);
+        inFd = -1;
+    }
+    if (reader.joinable()) reader.join();
+    if (outFd >= 0) {
+        close(outFd);
+        outFd = -1;
+    }
+    if (pid <= 0) return false;
+
+    int wstatus;
+    while (waitpid(pid, &wstatus, 0) < 0 && errno == EINTR) {}
+    pid = -1;
+    // MaxSAT solvers use 0 or the MaxSAT Evaluation exit codes (10: satisfiable, 20: unsatisfiable, 30: optimum),
+    // any other exit status (including 127 if the command was not found) means that the solver failed
+    if (!WIFEXITED(wstatus)) return false;
+    int code = WEXITSTATUS(wstatus);
+    return code == 0 || code == 10 || code == 20 || code == 30;
+}
+
+void MaxSatProcess::readOutput() {
+    string line;
+    char buffer[1 << 16];
+    ssize_t n;
+    while ((n = read(outFd, buffer, sizeof(buffer))) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (ssize_t i = 0; i < n; i++) {
+            if (buffer[i] != '\n') {
+                line.push_back(buffer[i]);
+                continue;
+            }
+            if (line.size() >= 2 && line[0] == 'v' && line[1] == ' ')
+                parseModelLine(line.data() + 2, line.data() + line.size(), solverModel);
+            else if (line.size() >= 2 && line[0] == 's' && line[1] == ' ')
+                solverStatus = line.substr(2);
+            line.clear();
+        }
+    }
+    if (line.size() >= 2 && line[0] == 'v' && line[1] == ' ')
+        parseModelLine(line.data() + 2, line.data() + line.size(), solverModel);
+}
+
+void MaxSatProcess::parseModelLine(const char* p, const char* end, vector<bool>& model) {
+    while (p < end && *p == ' ') p++;
+    while (end > p && (end[-1] == ' ' || end[-1] == '\r')) end--;
+
+    // MaxSAT Evaluation 2022 format: one character '0'/'1' per variable. A short string of 0s and 1s (such as "10")
+    // is read as a classic literal instead, a literal has at most 10 digits and the encodings have more variables
+    bool binary = end - p > 10;
+    for (const char* c = p; binary && c < end; c++) binary = *c == '0' || *c == '1';
+    if (binary) {
+        for (const char* c = p; c < end; c++) model.push_back(*c == '1');
+        return;
+    }
+
+    // Classic format: list of literals
+    while (p < end) {
+        while (p < end && *p == ' ') p++;
+        bool negative = p < end && *p == '-';
+        if (negative) p++;
+        int v = 0;
+        while (p < end && *p >= '0' && *p <= '9') v = v * 10 + (*p++ - '0');
+        while (p < end && *p != ' ') p++;
+        if (v == 0) continue;
+        if ((int)model.size() < v) model.resize(v, false);
+        model[v - 1] = !negative;
+    }
+}
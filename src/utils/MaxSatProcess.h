@@ -0,0 +1,98 @@
+/*********************************************************************************[MaxSatProcess.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+#ifndef RCPSPT_EXACT_MAXSATPROCESS_H
+#define RCPSPT_EXACT_MAXSATPROCESS_H
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/types.h>
+
+using namespace std;
+
+namespace RcpsptExact {
+
+/**
+ * External MaxSAT solver process, which reads an instance from its standard input.
+ * The solver output is read on a separate thread while the instance is being written, and the status ('s')
+ * and model ('v') lines are collected. Both the classic model format (list of literals, possibly spread over
+ * multiple 'v' lines) and the MaxSAT Evaluation 2022 format (a single string of 0s and 1s) are supported. A line with
+ * a string of at most 10 0s and 1s is ambiguous, and is read as a classic literal (for example "v 10" sets variable 10).
+ */
+class MaxSatProcess {
+public:
+    /**
+     * Starts the solver process.
+     *
+     * @param command shell command that runs the solver, reading the instance from standard input
+     */
+    explicit MaxSatProcess(const string& command);
+    ~MaxSatProcess();
+
+    /**
+     * @return the file descriptor for writing the instance to the solver, -1 if the solver could not be started
+     */
+    int input() const { return inFd; }
+
+    /**
+     * Closes the input of the solver, and waits until the solver has exited.
+     *
+     * @return true if the solver exited with status 0, 10, 20 or 30, false otherwise (crashed or failed)
+     */
+    bool finish();
+
+    /**
+     * @return the status reported by the solver (for example "OPTIMUM FOUND"), empty if none was reported
+     */
+    const string& status() const { return solverStatus; }
+
+    /**
+     * @return for each variable (index 0 is variable 1) whether it is true in the model, empty if there is no model
+     */
+    const vector<bool>& model() const { return solverModel; }
+
+    /**
+     * Parses the contents of a model ('v') line, without the leading "v ", and adds the assignments to model.
+     *
+     * @param p pointer to the first character of the line
+     * @param end pointer past the last character of the line
+     * @param model for each variable (index 0 is variable 1) whether it is true, is extended as needed
+     */
+    static void parseModelLine(const char* p, const char* end, vector<bool>& model);
+
+private:
+    pid_t pid = -1;
+    int inFd = -1;  // Write end of the solver's standard input
+    int outFd = -1; // Read end of the solver's standard output
+    thread reader;
+
+    string solverStatus;
+    vector<bool> solverModel;
+
+    void readOutput();
+};
+}
+
+#endif //RCPSPT_EXACT_MAXSATPROCESS_H
@@ -0,0 +1,69 @@
+/***********************************************************************************[ParallelFor.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+#ifndef RCPSPT_EXACT_PARALLELFOR_H
+#define RCPSPT_EXACT_PARALLELFOR_H
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace RcpsptExact {
+
+/**
+ * Gets the number of worker threads to use when none was specified.
+ */
+inline int defaultThreadCount() {
+    return max(1, (int)thread::hardware_concurrency());
+}
+
+/**
+ * Runs f(i) for every i in [0, n), distributed dynamically over the given number of worker threads.
+ * Returns once all calls have finished. With a single thread, all calls are made on the calling thread, in order.
+ *
+ * @param n number of work items
+ * @param nthreads number of worker threads
+ * @param f function to call for each work item
+ */
+inline void parallelFor(int n, int nthreads, const function<void(int)>& f) {
+    nthreads = max(1, min(nthreads, n));
+    if (nthreads == 1) {
+        for (int i = 0; i < n; i++) f(i);
+        return;
+    }
+    atomic<int> next(0);
+    vector<thread> workers;
+    workers.reserve(nthreads);
+    for (int w = 0; w < nthreads; w++) {
+        workers.emplace_back([&]() {
+            for (int i = next++; i < n; i = next++) f(i);
+        });
+    }
+    for (thread& worker : workers) worker.join();
+}
+}
+
+#endif //RCPSPT_EXACT_PARALLELFOR_H
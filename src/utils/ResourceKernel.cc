@@ -0,0 +1,99 @@
+/*******************************************************************************[ResourceKernel.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RCPSPT_EXACT_X86
+#endif
+
+#include "ResourceKernel.h"
+
+using namespace RcpsptExact;
+
+static int firstViolationScalar(const int* requests, const int* capacities, int duration) {
+    for (int t = 0; t < duration; t++)
+        if (requests[t] > capacities[t]) return t;
+    return -1;
+}
+
+static uint32_t violationMaskScalar(const int* requests, const int* capacities, int duration, int nstarts) {
+    uint32_t mask = 0;
+    for (int j = 0; j < nstarts; j++) {
+        for (int t = 0; t < duration; t++) {
+            if (requests[t] > capacities[j + t]) {
+                mask |= (uint32_t)1 << j;
+                break;
+            }
+        }
+    }
+    return mask;
+}
+
+#ifdef RCPSPT_EXACT_X86
+__attribute__((target("avx2")))
+static int firstViolationAvx2(const int* requests, const int* capacities, int duration) {
+    int t = 0;
+    for (; t + 8 <= duration; t += 8) {
+        __m256i r = _mm256_loadu_si256((const __m256i*)(requests + t));
+        __m256i c = _mm256_loadu_si256((const __m256i*)(capacities + t));
+        int violated = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(r, c)));
+        if (violated != 0) return t + __builtin_ctz(violated);
+    }
+    for (; t < duration; t++)
+        if (requests[t] > capacities[t]) return t;
+    return -1;
+}
+
+__attribute__((target("avx2")))
+static uint32_t violationMaskAvx2(const int* requests, const int* capacities, int duration, int nstarts) {
+    // Each vector lane is a candidate start time, the request at offset t is compared to the capacities at start+t
+    uint32_t mask = 0;
+    int j = 0;
+    for (; j + 8 <= nstarts; j += 8) {
+        __m256i violated = _mm256_setzero_si256();
+        for (int t = 0; t < duration; t++) {
+            __m256i c = _mm256_loadu_si256((const __m256i*)(capacities + j + t));
+            violated = _mm256_or_si256(violated, _mm256_cmpgt_epi32(_mm256_set1_epi32(requests[t]), c));
+        }
+        mask |= (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(violated)) << j;
+    }
+    if (j < nstarts) mask |= violationMaskScalar(requests, capacities + j, duration, nstarts - j) << j;
+    return mask;
+}
+#endif
+
+bool ResourceKernel::useAvx2(bool avx2) {
+#ifdef RCPSPT_EXACT_X86
+    if (avx2 && __builtin_cpu_supports("avx2")) {
+        firstViolationImpl = firstViolationAvx2;
+        violationMaskImpl = violationMaskAvx2;
+        return true;
+    }
+#endif
+    firstViolationImpl = firstViolationScalar;
+    violationMaskImpl = violationMaskScalar;
+    return false;
+}
+
+int (*ResourceKernel::firstViolationImpl)(const int*, const int*, int) = firstViolationScalar;
+uint32_t (*ResourceKernel::violationMaskImpl)(const int*, const int*, int, int) = violationMaskScalar;
+static const bool avx2Selected = ResourceKernel::useAvx2(true); // Select the implementation once, at startup
@@ -0,0 +1,76 @@
+/********************************************************************************[ResourceKernel.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#ifndef RCPSPT_EXACT_RESOURCEKERNEL_H
+#define RCPSPT_EXACT_RESOURCEKERNEL_H
+
+#include <cstdint>
+
+namespace RcpsptExact {
+
+/**
+ * Kernels comparing the requests of a job to the (remaining) capacities of a resource over a window of time steps.
+ * They are vectorised with AVX2 when the CPU supports it (detected at runtime), and use scalar code otherwise.
+ */
+class ResourceKernel {
+public:
+    static constexpr int MAX_STARTS = 32; // Maximum number of candidate start times for violationMask()
+
+    /**
+     * @param requests requests of the job for each time step of its duration
+     * @param capacities capacities at the time steps the job would be running (capacities[t] for requests[t])
+     * @param duration number of time steps to compare
+     * @return the first offset t at which requests[t] > capacities[t], or -1 if there is none (the window is feasible)
+     */
+    static int firstViolation(const int* requests, const int* capacities, int duration) {
+        return firstViolationImpl(requests, capacities, duration);
+    }
+
+    /**
+     * Checks several consecutive candidate start times at once.
+     * Requires capacities[0, nstarts+duration-1) to be readable.
+     *
+     * @param requests requests of the job for each time step of its duration
+     * @param capacities capacities starting at the first candidate start time
+     * @param duration duration of the job
+     * @param nstarts number of candidate start times (at most MAX_STARTS)
+     * @return mask in which bit j is set if starting at candidate j violates the capacities at some time step
+     */
+    static uint32_t violationMask(const int* requests, const int* capacities, int duration, int nstarts) {
+        return violationMaskImpl(requests, capacities, duration, nstarts);
+    }
+
+    /**
+     * Selects the implementation to use, which is otherwise detected automatically (for benchmarks).
+     *
+     * @param avx2 whether to use the AVX2 implementation (ignored if the CPU does not support it)
+     * @return true if the AVX2 implementation is used
+     */
+    static bool useAvx2(bool avx2);
+
+private:
+    static int (*firstViolationImpl)(const int*, const int*, int);
+    static uint32_t (*violationMaskImpl)(const int*, const int*, int, int);
+};
+}
+
+#endif //RCPSPT_EXACT_RESOURCEKERNEL_H
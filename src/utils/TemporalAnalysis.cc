@@ -0,0 +1,113 @@
+/*****************************************************************************[TemporalAnalysis.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#include "TemporalAnalysis.h"
+
+using namespace RcpsptExact;
+
+TemporalAnalysis::TemporalAnalysis(const Problem& problem)
+        : njobs(problem.njobs),
+          feasibility(problem),
+          durations(problem.durations) {
+    succOffsets.reserve(njobs + 1);
+    predOffsets.reserve(njobs + 1);
+    succOffsets.push_back(0);
+    predOffsets.push_back(0);
+    for (int i = 0; i < njobs; i++) {
+        succData.insert(succData.end(), problem.successors[i].begin(), problem.successors[i].end());
+        predData.insert(predData.end(), problem.predecessors[i].begin(), problem.predecessors[i].end());
+        succOffsets.push_back((int)succData.size());
+        predOffsets.push_back((int)predData.size());
+    }
+
+    // Topological order (Kahn's algorithm), in which each activity comes after all of its predecessors
+    vector<int> remaining(njobs);
+    order.reserve(njobs);
+    for (int i = 0; i < njobs; i++) {
+        remaining[i] = predOffsets[i + 1] - predOffsets[i];
+        if (remaining[i] == 0) order.push_back(i);
+    }
+    for (int o = 0; o < (int)order.size(); o++) {
+        int job = order[o];
+        for (int s = succOffsets[job]; s < succOffsets[job + 1]; s++)
+            if (--remaining[succData[s]] == 0) order.push_back(succData[s]);
+    }
+}
+
+shared_ptr<const TimeWindows> TemporalAnalysis::windows(int UB) const {
+    {
+        lock_guard<mutex> lock(cacheMutex);
+        auto it = cache.find(UB);
+        if (it != cache.end()) return it->second;
+    }
+    // Calculated outside the lock, if another thread calculated the same windows in the meantime those are used
+    shared_ptr<const TimeWindows> result = calcWindows(UB);
+    lock_guard<mutex> lock(cacheMutex);
+    return cache.emplace(UB, result).first->second;
+}
+
+shared_ptr<const TimeWindows> TemporalAnalysis::calcWindows(int UB) const {
+    auto result = make_shared<TimeWindows>();
+    result->feasible = false;
+    result->lowerBound = 0;
+    result->ES.resize(njobs);
+    result->EC.resize(njobs, 0);
+    result->LS.resize(njobs, UB);
+    result->LC.resize(njobs);
+    vector<int>& EC = result->EC;
+    vector<int>& LS = result->LS;
+    if ((int)order.size() < njobs) return result; // The precedence graph contains a cycle
+
+    // Calculate earliest feasible finish (close) times, using the definition from Hartmann (2013) (reference in README.md)
+    // All predecessors of a job are final before it is reached, so it only needs to be moved once
+    for (int job : order) {
+        int duration = durations[job];
+        for (int p = predOffsets[job]; p < predOffsets[job + 1]; p++) {
+            int c = EC[predData[p]] + duration;
+            if (c > EC[job]) EC[job] = c; // Use maximum values, because we are interested in critical paths
+        }
+        // Move finish until it is feasible considering resource constraints
+        int start = feasibility.nextStart(job, EC[job] - duration);
+        if (start < 0 || start + duration > UB) return result;
+        EC[job] = start + duration;
+    }
+    result->lowerBound = EC.back();
+
+    // Calculate latest feasible start times, again using the definition from Hartmann (2013) (reference in README.md)
+    for (int o = njobs - 1; o >= 0; o--) {
+        int job = order[o];
+        for (int s = succOffsets[job]; s < succOffsets[job + 1]; s++) {
+            int start = LS[succData[s]] - durations[job];
+            if (start < LS[job]) LS[job] = start; // Use minimum values for determining critical paths
+        }
+        // Move start until it is feasible considering resource constraints
+        LS[job] = feasibility.prevStart(job, LS[job]);
+        if (LS[job] < 0) return result;
+    }
+
+    for (int i = 0; i < njobs; i++) {
+        result->ES[i] = EC[i] - durations[i];
+        result->LC[i] = LS[i] + durations[i];
+    }
+    result->feasible = true;
+    return result;
+}
@@ -0,0 +1,92 @@
+/******************************************************************************[TemporalAnalysis.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#ifndef RCPSPT_EXACT_TEMPORALANALYSIS_H
+#define RCPSPT_EXACT_TEMPORALANALYSIS_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "../Problem.h"
+#include "FeasibilityIndex.h"
+
+using namespace std;
+
+namespace RcpsptExact {
+
+/**
+ * Earliest/latest start and close times of each activity, for a given upper bound on the makespan.
+ */
+struct TimeWindows {
+    bool feasible; // Whether all time windows lie within the upper bound
+    int lowerBound; // Earliest close time of the end dummy activity (0 if the forward pass failed)
+    vector<int> ES, EC, LS, LC; // For each activity: earliest start, earliest close, latest start, and latest close time
+};
+
+/**
+ * Temporal analysis of an instance, shared by the heuristic and all encoders (see Problem::temporal).
+ * It holds the FeasibilityIndex and a topological order of the precedence graph, which are built once. Time windows
+ * are calculated with one forward and one backward pass over that order, so that each activity is only shifted once
+ * per pass, and cached per upper bound.
+ *
+ * The analysis keeps its own copy of the data it needs, so it does not refer to the Problem it was built from.
+ */
+class TemporalAnalysis {
+public:
+    explicit TemporalAnalysis(const Problem& problem);
+
+    /**
+     * @return feasible start times of each job considering only the resource capacities
+     */
+    const FeasibilityIndex& index() const { return feasibility; }
+
+    /**
+     * @return the activities in topological order of the precedence graph (each one after all of its predecessors)
+     */
+    const vector<int>& topologicalOrder() const { return order; }
+
+    /**
+     * Calculates the time windows for an upper bound, or gets them from the cache. Safe to call from multiple threads.
+     *
+     * @param UB upper bound on the makespan
+     * @return time windows, using the definitions from Hartmann (2013) (reference in README.md)
+     */
+    shared_ptr<const TimeWindows> windows(int UB) const;
+
+private:
+    int njobs;
+    FeasibilityIndex feasibility;
+    vector<int> durations;
+    vector<int> order; // Topological order of the precedence graph
+    vector<int> succOffsets, succData; // Successors of each activity (CSR-style)
+    vector<int> predOffsets, predData; // Predecessors of each activity (CSR-style)
+
+    mutable mutex cacheMutex;
+    mutable map<int, shared_ptr<const TimeWindows>> cache; // Time windows per upper bound
+
+    shared_ptr<const TimeWindows> calcWindows(int UB) const;
+};
+}
+
+#endif //RCPSPT_EXACT_TEMPORALANALYSIS_H
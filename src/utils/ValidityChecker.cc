@@ -23,19 +23,15 @@ SOFTWARE.
 #include <iostream>
 
 #include "ValidityChecker.h"
+#include "ResourceKernel.h"
 
 using namespace RcpsptExact;
 
 bool ValidityChecker::checkValid(const Problem &problem, const vector<int> &solution) {
     if (solution.empty()) return false;
 
-    // Initialize remaining resource availabilities
-    int **available = new int *[problem.nresources];
-    for (int k = 0; k < problem.nresources; k++) {
-        available[k] = new int[problem.horizon];
-        for (int t = 0; t < problem.horizon; t++)
-            available[k][t] = problem.capacities[k][t];
-    }
+    // Initialize remaining resource availabilities (same layout as the capacities in Problem)
+    vector<int> available(problem.capacities(0), problem.capacities(0) + problem.nresources * problem.horizon);
 
     for (int job = 0; job < problem.njobs; job++) {
         // Precedence constraints
@@ -50,20 +46,17 @@ bool ValidityChecker::checkValid(const Problem &problem, const vector<int> &solu
     for (int job = 0; job < problem.njobs; job++) {
         // Resource constraints
         for (int k = 0; k < problem.nresources; k++) {
-            for (int t = 0; t < problem.durations[job]; t++) {
-                int curr = solution[job] + t;
-                available[k][curr] -= problem.requests[job][k][t];
-                if (available[k][curr] < 0) {
-                    std::cout << "resource demand exceeds availability at t=" << curr << '!'
-                              << std::endl;
-                    return false;
-                }
+            const int* requests = problem.requests(job, k);
+            int* remaining = &available[k * problem.horizon + solution[job]];
+            int violation = ResourceKernel::firstViolation(requests, remaining, problem.durations[job]);
+            if (violation >= 0) {
+                std::cout << "resource demand exceeds availability at t=" << solution[job] + violation << '!'
+                          << std::endl;
+                return false;
             }
+            for (int t = 0; t < problem.durations[job]; t++) remaining[t] -= requests[t];
         }
     }
 
-    for (int i = 0; i < problem.nresources; i++) delete[] available[i];
-    delete[] available;
-
     return true;
 }
@@ -0,0 +1,126 @@
+/***********************************************************************************[WcnfWriter.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+#include "WcnfWriter.h"
+
+using namespace RcpsptExact;
+
+static const size_t BUFFER_SIZE = 1 << 20;
+static const int HEADER_WIDTH = 47; // Width of the "p wcnf" line, excluding the newline
+static const int COMMENT_WIDTH = 127; // Width of the deferred comment line, excluding the newline
+
+WcnfWriter::WcnfWriter(int fd, bool headerless, bool cnf)
+        : fd(fd), headerless(headerless && !cnf), plain(cnf), buffer(BUFFER_SIZE) {}
+
+WcnfWriter::~WcnfWriter() = default;
+
+void WcnfWriter::comment(const vector<int>& values) {
+    if (pos + 2 > buffer.size()) flush();
+    buffer[pos++] = 'c';
+    for (int v : values) {
+        if (pos + 16 > buffer.size()) flush();
+        buffer[pos++] = ' ';
+        writeInt(v);
+    }
+    buffer[pos++] = '\n';
+}
+
+void WcnfWriter::header() {
+    if (headerless) return;
+    if (pos + HEADER_WIDTH + 1 > buffer.size()) flush();
+    headerPos = written + (long long)pos;
+    for (int i = 0; i < HEADER_WIDTH; i++) buffer[pos++] = ' ';
+    buffer[pos++] = '\n';
+}
+
+void WcnfWriter::deferredComment() {
+    if (pos + COMMENT_WIDTH + 1 > buffer.size()) flush();
+    if (lseek(fd, 0, SEEK_CUR) >= 0) deferredPos = written + (long long)pos;
+    buffer[pos++] = 'c';
+    for (int i = 1; i < COMMENT_WIDTH; i++) buffer[pos++] = ' ';
+    buffer[pos++] = '\n';
+}
+
+void WcnfWriter::beginHard() {
+    if (pos + 16 > buffer.size()) flush();
+    if (headerless) buffer[pos++] = 'h';
+    else if (!plain) writeInt(TOP);
+    else return; // A clause in plain CNF only has literals
+    buffer[pos++] = ' ';
+}
+
+void WcnfWriter::beginSoft(int weight) {
+    if (pos + 16 > buffer.size()) flush();
+    writeInt(weight);
+    buffer[pos++] = ' ';
+}
+
+void WcnfWriter::endClause() {
+    if (pos + 2 > buffer.size()) flush();
+    buffer[pos++] = '0';
+    buffer[pos++] = '\n';
+    nclauses++;
+}
+
+void WcnfWriter::flush() {
+    size_t done = 0;
+    while (done < pos && !failed) {
+        ssize_t n = write(fd, buffer.data() + done, pos - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Writing WCNF output failed: " << strerror(errno) << std::endl;
+            failed = true;
+            break;
+        }
+        done += (size_t)n;
+    }
+    written += (long long)pos;
+    pos = 0;
+}
+
+bool WcnfWriter::finish(int nbvar) {
+    flush();
+    if (headerPos >= 0 && !failed) {
+        string line = plain ? "p cnf " + to_string(nbvar) + ' ' + to_string(nclauses)
+                            : "p wcnf " + to_string(nbvar) + ' ' + to_string(nclauses) + ' ' + to_string(TOP);
+        line.resize(HEADER_WIDTH, ' ');
+        if (pwrite(fd, line.data(), line.size(), headerPos) != (ssize_t)line.size()) {
+            std::cerr << "Writing WCNF header failed: " << strerror(errno) << std::endl;
+            failed = true;
+        }
+    }
+    if (deferredPos >= 0 && !deferredLine.empty() && !failed) {
+        string line = deferredLine;
+        line.resize(COMMENT_WIDTH, ' ');
+        if (pwrite(fd, line.data(), line.size(), deferredPos) != (ssize_t)line.size()) {
+            std::cerr << "Writing WCNF comment failed: " << strerror(errno) << std::endl;
+            failed = true;
+        }
+    }
+    return !failed;
+}
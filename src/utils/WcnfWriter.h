@@ -0,0 +1,150 @@
+/************************************************************************************[WcnfWriter.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+#ifndef RCPSPT_EXACT_WCNFWRITER_H
+#define RCPSPT_EXACT_WCNFWRITER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../encoders/ads/ClauseBuffer.h"
+
+using namespace std;
+
+namespace RcpsptExact {
+
+/**
+ * Buffered writer for (weighted) MaxSAT instances in WCNF format.
+ * Clauses are formatted directly into a reusable byte buffer, which is flushed to the output as it fills up,
+ * so the encoding never has to be held in memory as a whole.
+ *
+ * Two output formats are supported:
+ *  - the classic format, starting with a "p wcnf nbvar nbclauses top" line. Because the totals are only known
+ *    at the end, a fixed-width placeholder line is written first and overwritten in finish().
+ *    This requires a seekable output (a regular file).
+ *  - the headerless format of the MaxSAT Evaluation 2022 onwards, where hard clauses start with 'h'.
+ *    This works for any output, including pipes.
+ * It can also write plain CNF in DIMACS format (with a "p cnf nbvar nbclauses" line), which only has hard clauses.
+ *
+ * As a ClauseSink it writes the clauses of a ClauseBuffer as hard clauses.
+ */
+class WcnfWriter : public ClauseSink {
+public:
+    /**
+     * @param fd file descriptor to write to (is not closed by the writer)
+     * @param headerless whether to use the headerless (2022) format instead of the classic format
+     * @param cnf whether to write plain CNF instead (soft clauses cannot be written, headerless is ignored)
+     */
+    WcnfWriter(int fd, bool headerless, bool cnf = false);
+    ~WcnfWriter();
+
+    static const int TOP = INT32_MAX/2; // Weight used for hard clauses in the classic format
+
+    /**
+     * Writes a comment line "c [values separated by spaces]" (just "c" if no values are given).
+     */
+    void comment(const vector<int>& values);
+
+    /**
+     * Writes the "p wcnf" (or "p cnf") placeholder line (not in the headerless format), must be called after the leading comments.
+     */
+    void header();
+
+    /**
+     * Writes a fixed-width comment line whose text is only known once all clauses have been written, and is filled in
+     * by finish() (see setDeferredComment). Until then the line is an empty comment, which it stays if the output is
+     * not seekable (such as a pipe).
+     */
+    void deferredComment();
+
+    /**
+     * Sets the text of the line written by deferredComment, starting with "c " (truncated to the width of the line).
+     */
+    void setDeferredComment(const string& line) { deferredLine = line; }
+
+    void beginHard();
+    void beginSoft(int weight);
+
+    /**
+     * Adds a literal to the current clause: variable index v (1-based) if positive, its negation if negative.
+     */
+    inline void lit(int v) {
+        if (pos + 16 > buffer.size()) flush();
+        writeInt(v);
+        buffer[pos++] = ' ';
+    }
+
+    void endClause();
+
+    void clause(const int* lits, int n) override {
+        beginHard();
+        for (int i = 0; i < n; i++) lit(lits[i]);
+        endClause();
+    }
+
+    /**
+     * Flushes the remaining output, and fills in the "p wcnf" (or "p cnf") line and the deferred comment line (if any).
+     *
+     * @param nbvar total number of variables
+     * @return false if writing to the output failed, true otherwise
+     */
+    bool finish(int nbvar);
+
+    int nClauses() const { return nclauses; }
+
+    bool cnf() const { return plain; }
+
+private:
+    int fd;
+    bool headerless;
+    bool plain; // Whether plain CNF is written
+    vector<char> buffer;
+    size_t pos = 0;           // Number of bytes in use in the buffer
+    long long written = 0;    // Number of bytes already written to the output
+    long long headerPos = -1; // Position of the "p wcnf" line in the output
+    long long deferredPos = -1; // Position of the deferred comment line in the output (-1 if none, or not seekable)
+    string deferredLine;
+    int nclauses = 0;
+    bool failed = false;
+
+    void flush();
+
+    inline void writeInt(int v) {
+        unsigned int u = (unsigned int)v;
+        if (v < 0) {
+            buffer[pos++] = '-';
+            u = 0u - u;
+        }
+        char digits[10];
+        int n = 0;
+        do {
+            digits[n++] = (char)('0' + u % 10);
+            u /= 10;
+        } while (u != 0);
+        while (n > 0) buffer[pos++] = digits[--n];
+    }
+};
+}
+
+#endif //RCPSPT_EXACT_WCNFWRITER_H